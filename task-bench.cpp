@@ -0,0 +1,460 @@
+// Benchmarks for task-cli internals.
+// Build with:  g++ task-bench.cpp -o task-bench -std=c++20 -O2
+// Run with:    ./task-bench [--sizes 1000,100000] [--min-time <seconds>] [--filter <name>]
+//
+// Every benchmark reports wall time per operation, throughput over the bytes it processes
+// and the number/size of heap allocations per operation (from task-cli's allocation
+// counters). Store-level benchmarks run in a scratch directory of their own against
+// generated stores of each requested size; pass --sizes 1000,100000,10000000 to include the
+// 10M-task store (several GB of disk and RAM).
+
+#define TASK_CLI_NO_MAIN
+#include "task-cli.cpp"
+
+#include <filesystem>
+#include <random>
+
+// --- Benchmark Helpers ---
+
+struct BenchOptions
+{
+    std::vector<size_t> sizes{1'000, 100'000};
+    double minSeconds = 0.3;
+    std::string filter; // Only run benchmarks whose name contains this
+};
+
+BenchOptions options;
+
+// Swallows the CLI's progress messages while end-to-end operations run
+class QuietStdout
+{
+public:
+    QuietStdout() : saved(std::cout.rdbuf(sink.rdbuf())) {}
+    ~QuietStdout() { std::cout.rdbuf(saved); }
+
+private:
+    std::ostringstream sink;
+    std::streambuf *saved;
+};
+
+// Runs fn repeatedly (doubling the batch size) until at least minSeconds have elapsed, then
+// reports ns/op, MB/s over bytesPerOp, and allocations per op. `setup` runs untimed before
+// every call, for benchmarks that need a fresh input each time.
+template <typename Fn, typename Setup>
+void measure(const std::string &name, double bytesPerOp, Fn &&fn, Setup &&setup)
+{
+    if (!options.filter.empty() && name.find(options.filter) == std::string::npos)
+    {
+        return;
+    }
+
+    setup();
+    fn(); // Warm-up
+
+    size_t iterations = 0;
+    size_t batch = 1;
+    double elapsedNs = 0;
+    uint64_t allocs = 0;
+    uint64_t allocBytes = 0;
+    while (elapsedNs < options.minSeconds * 1e9)
+    {
+        for (size_t i = 0; i < batch; ++i)
+        {
+            setup();
+            uint64_t allocsBefore = allocationCount.load();
+            uint64_t bytesBefore = allocationBytes.load();
+            auto start = std::chrono::steady_clock::now();
+            fn();
+            elapsedNs += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+            allocs += allocationCount.load() - allocsBefore;
+            allocBytes += allocationBytes.load() - bytesBefore;
+        }
+        iterations += batch;
+        batch *= 2;
+    }
+
+    double n = static_cast<double>(iterations);
+    double nsPerOp = elapsedNs / n;
+    double mbPerSec = nsPerOp > 0 ? bytesPerOp / nsPerOp * 1e3 : 0.0; // bytes/ns * 1000 == MB/s
+    std::cout << std::format("{:<44} {:>14.1f} ns/op {:>10.1f} MB/s {:>12.1f} allocs/op {:>14.1f} B/op\n",
+                             name, nsPerOp, mbPerSec, static_cast<double>(allocs) / n,
+                             static_cast<double>(allocBytes) / n);
+}
+
+template <typename Fn>
+void measure(const std::string &name, double bytesPerOp, Fn &&fn)
+{
+    measure(name, bytesPerOp, std::forward<Fn>(fn), [] {});
+}
+
+// Keeps results observable so the optimizer cannot drop the benchmarked work
+size_t sink = 0;
+
+// Stores come from the same generator as 'task-cli gen', so they are reproducible from the seed
+TaskList makeTasks(size_t count)
+{
+    GenOptions generate;
+    generate.count = count;
+    generate.seed = 7;
+    return generateTasks(generate);
+}
+
+// --- Microbenchmarks ---
+
+void benchJsonHelpers()
+{
+    std::cout << "\nJSON helpers\n";
+
+    const std::string plain = "Finish project report before the Monday review meeting";
+    measure("escapeJsonString (plain, 55 B)", static_cast<double>(plain.size()), [&]
+            { sink += escapeJsonString(plain).size(); });
+
+    const std::string quoted = R"(Reply to "Re: budget" \ check C:\temp\notes)";
+    measure("escapeJsonString (quotes/backslashes)", static_cast<double>(quoted.size()), [&]
+            { sink += escapeJsonString(quoted).size(); });
+
+    const std::string control = "Line one\nLine two\tindented\r\nend";
+    measure("escapeJsonString (control characters)", static_cast<double>(control.size()), [&]
+            { sink += escapeJsonString(control).size(); });
+
+    // Into a reused buffer, as saveTasks() does: no allocation, clean runs are bulk copies
+    const std::string longPlain(4096, 'x');
+    std::string buffer;
+    buffer.reserve(2 * longPlain.size());
+    measure("appendJsonEscaped (plain, 4 KB, reused buffer)", static_cast<double>(longPlain.size()), [&]
+            {
+        buffer.clear();
+        appendJsonEscaped(buffer, longPlain);
+        sink += buffer.size(); });
+    measure("appendJsonEscaped (plain, 4 KB, scalar scan)", static_cast<double>(longPlain.size()), [&]
+            {
+        buffer.clear();
+        appendJsonEscaped(buffer, longPlain, findJsonEscapeScalar);
+        sink += buffer.size(); });
+
+    const std::string object = "\n    \"id\": 42,\n"
+                               "    \"description\": \"Finish project report\",\n"
+                               "    \"status\": \"in-progress\",\n"
+                               "    \"createdAt\": \"2025-04-09 11:00:00\",\n"
+                               "    \"updatedAt\": \"2025-04-09 11:00:00\"\n  ";
+    measure("findJsonValue (id, first key)", static_cast<double>(object.size()), [&]
+            { sink += findJsonValue(object, "id").size(); });
+    measure("findJsonValue (updatedAt, last key)", static_cast<double>(object.size()), [&]
+            { sink += findJsonValue(object, "updatedAt").size(); });
+    measure("scanTaskFields (all fields, one pass)", static_cast<double>(object.size()), [&]
+            { sink += scanTaskFields(object)[TASK_FIELD_COUNT - 1].size(); });
+    const std::string canonical = "{" + object + "}";
+    measure("matchCanonicalTask (all fields)", static_cast<double>(canonical.size()), [&]
+            {
+        RawTaskFields fields;
+        sink += matchCanonicalTask(canonical, 1, fields); });
+
+    const std::string escaped = R"(Reply to \"Re: budget\" \u00e9\ud83d\ude00 line\nbreak)";
+    measure("unescapeJsonString (escaped)", static_cast<double>(escaped.size()), [&]
+            { sink += unescapeJsonString(escaped).size(); });
+}
+
+// Compares the per-task std::string::find loop with scans of the description column
+void benchSearch(size_t count)
+{
+    TaskList tasks = makeTasks(count);
+    TaskColumns columns(tasks);
+    const std::string needle = "appointment";
+    const double bytes = static_cast<double>(columns.descriptions.size());
+    const std::string suffix = std::format(" [{}]", count);
+
+    measure("search: naive std::string::find loop" + suffix, bytes, [&]
+            {
+        for (const auto &task : tasks)
+        {
+            if (task.getDescription().find(needle) != std::string::npos)
+            {
+                sink++;
+            }
+        } });
+    measure("search: column scan (scalar)" + suffix, bytes, [&]
+            { sink += searchDescriptions(columns, needle, findSubstringScalar).size(); });
+#if TASK_CLI_X86_SIMD
+    measure("search: column scan (SSE2)" + suffix, bytes, [&]
+            { sink += searchDescriptions(columns, needle, findSubstringSse2).size(); });
+    if (__builtin_cpu_supports("avx2"))
+    {
+        measure("search: column scan (AVX2)" + suffix, bytes, [&]
+                { sink += searchDescriptions(columns, needle, findSubstringAvx2).size(); });
+    }
+#endif
+    measure("columns build" + suffix, bytes, [&]
+            { TaskColumns rebuilt(tasks); sink += rebuilt.size(); });
+}
+
+// Compares counting/selecting by status through the Task vector with the status column kernels
+void benchStatus(size_t count)
+{
+    TaskList tasks = makeTasks(count);
+    TaskColumns columns(tasks);
+    std::span<const TaskStatus> status = columns.status;
+    std::vector<uint64_t> bitmap((status.size() + 63) / 64);
+    const double bytes = static_cast<double>(status.size());
+    const std::string suffix = std::format(" [{}]", count);
+
+    measure("status count: per-task string compare" + suffix, bytes, [&]
+            {
+        for (const auto &task : tasks)
+        {
+            sink += (task.getStatus() == "todo");
+            sink += (task.getStatus() == "in-progress");
+        } });
+    measure("status count: column (scalar)" + suffix, bytes, [&]
+            { sink += countStatusesScalar(status)[0]; });
+    measure("status select: column (scalar)" + suffix, bytes, [&]
+            { sink += selectStatusScalar(status, TaskStatus::Todo, bitmap.data()); });
+#if TASK_CLI_X86_SIMD
+    measure("status count: column (SSE2)" + suffix, bytes, [&]
+            { sink += countStatusesSse2(status)[0]; });
+    measure("status select: column (SSE2)" + suffix, bytes, [&]
+            { sink += selectStatusSse2(status, TaskStatus::Todo, bitmap.data()); });
+    if (__builtin_cpu_supports("avx2"))
+    {
+        measure("status count: column (AVX2)" + suffix, bytes, [&]
+                { sink += countStatusesAvx2(status)[0]; });
+        measure("status select: column (AVX2)" + suffix, bytes, [&]
+                { sink += selectStatusAvx2(status, TaskStatus::Todo, bitmap.data()); });
+    }
+#endif
+}
+
+// loadTasks/saveTasks and end-to-end commands against a generated store of `count` tasks
+void benchStore(size_t count)
+{
+    std::cout << std::format("\nStore with {} tasks\n", count);
+    saveTasks(makeTasks(count));
+    const std::string pristine = TASKS_FILE + ".pristine";
+    std::filesystem::copy_file(TASKS_FILE, pristine, std::filesystem::copy_options::overwrite_existing);
+    const double fileBytes = static_cast<double>(std::filesystem::file_size(TASKS_FILE));
+    const std::string suffix = std::format(" [{}]", count);
+    auto restore = [&]
+    { std::filesystem::copy_file(pristine, TASKS_FILE, std::filesystem::copy_options::overwrite_existing); };
+
+    measure("loadTasks" + suffix, fileBytes, []
+            {
+        StringArena arena;
+        sink += loadTasks(arena).size(); });
+    measure("loadTasks (monotonic resource)" + suffix, fileBytes, []
+            {
+        std::pmr::monotonic_buffer_resource monotonic;
+        StringArena arena(&monotonic);
+        sink += loadTasks(arena).size(); });
+    measure("loadTasks (lazy)" + suffix, fileBytes, []
+            {
+        std::pmr::monotonic_buffer_resource monotonic;
+        StringArena arena(&monotonic);
+        sink += loadTasks(arena, true).size(); });
+
+    // Same store with the fields of each object on one line, which the canonical-layout matcher rejects
+    {
+        std::ifstream in(pristine, std::ios::binary);
+        std::string json((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        std::ofstream out(TASKS_FILE, std::ios::binary);
+        size_t start = 0;
+        for (size_t pos; (pos = json.find("\n    ", start)) != std::string::npos; start = pos + 5)
+        {
+            out << std::string_view(json).substr(start, pos - start) << ' ';
+        }
+        out << std::string_view(json).substr(start);
+    }
+    measure("loadTasks (generic layout)" + suffix, fileBytes, []
+            {
+        StringArena arena;
+        sink += loadTasks(arena).size(); });
+    restore();
+
+    StringArena arena;
+    TaskList tasks = loadTasks(arena);
+    measure("saveTasks" + suffix, fileBytes, [&]
+            { saveTasks(tasks); });
+    restore();
+
+    // The parsed-state cache is off for every other store benchmark, so they keep measuring the parser
+    parsedCacheEnabled = true;
+    measure("saveTasks (with cache write)" + suffix, fileBytes, [&]
+            { saveTasks(tasks); });
+    measure("loadTasks (cache hit)" + suffix, fileBytes, []
+            {
+        StringArena arena;
+        sink += loadTasks(arena).size(); });
+    parsedCacheEnabled = false;
+    std::filesystem::remove(CACHE_FILE);
+    restore();
+
+    // End-to-end commands: load, run the operation (which saves if it mutates), like main()
+    measure("add (end-to-end)" + suffix, fileBytes, [&]
+            {
+        QuietStdout quiet;
+        TaskStore store;
+        store.tasks = loadTasks(store.arena);
+        addTask(store, "Benchmark task"); }, restore);
+
+    // As main() runs 'add': the store is not loaded while tasks.json.meta matches the file. The
+    // warm-up run loads it once and writes the metadata. The store then grows by one task per
+    // run instead of being restored.
+    auto addUnloaded = [&]
+    {
+        QuietStdout quiet;
+        TaskStore store;
+        store.unloaded = true;
+        addTask(store, "Benchmark task");
+    };
+    measure("add (not loaded, end-to-end)" + suffix, fileBytes, addUnloaded);
+    restore();
+
+    measure("mark-done (end-to-end)" + suffix, fileBytes, [&]
+            {
+        QuietStdout quiet;
+        TaskStore store;
+        store.tasks = loadTasks(store.arena);
+        markTaskStatus(store, static_cast<int>(count / 2), "done"); }, restore);
+
+    // As main() runs 'mark-*': the task's object is patched in place while tasks.json.meta matches
+    measure("mark-done (not loaded, end-to-end)" + suffix, fileBytes, [&]
+            {
+        QuietStdout quiet;
+        TaskStore store;
+        store.unloaded = true;
+        markTaskStatus(store, static_cast<int>(count / 2), "done"); });
+    restore();
+
+    measure("show (end-to-end)" + suffix, fileBytes, [&]
+            {
+        QuietStdout quiet;
+        TaskStore store;
+        store.tasks = loadTasks(store.arena);
+        showTask(store, static_cast<int>(count / 2)); });
+
+    // As main() runs 'show': only the task's object is read while tasks.json.meta matches. A
+    // save (of the same tasks) brings the metadata up to date after restore().
+    saveTasks(tasks);
+    measure("show (not loaded, end-to-end)" + suffix, fileBytes, [&]
+            {
+        QuietStdout quiet;
+        TaskStore store;
+        store.unloaded = true;
+        showTask(store, static_cast<int>(count / 2)); });
+    restore();
+
+    measure("list todo (end-to-end)" + suffix, fileBytes, [&]
+            {
+        QuietStdout quiet;
+        TaskStore store;
+        store.tasks = loadTasks(store.arena);
+        listTasks(store, "todo"); });
+
+    measure("list todo (lazy, end-to-end)" + suffix, fileBytes, [&]
+            {
+        QuietStdout quiet;
+        std::pmr::monotonic_buffer_resource monotonic;
+        TaskStore store(&monotonic);
+        store.tasks = loadTasks(store.arena, true);
+        listTasks(store, "todo"); });
+
+    // The same store as NDJSON, where add appends one line instead of rewriting the file
+    storeFormat = StoreFormat::Ndjson;
+    saveTasks(tasks);
+    std::filesystem::copy_file(TASKS_FILE, pristine, std::filesystem::copy_options::overwrite_existing);
+    const double ndjsonBytes = static_cast<double>(std::filesystem::file_size(TASKS_FILE));
+    measure("loadTasks (ndjson)" + suffix, ndjsonBytes, []
+            {
+        StringArena arena;
+        sink += loadTasks(arena).size(); });
+    measure("add (ndjson, end-to-end)" + suffix, ndjsonBytes, [&]
+            {
+        QuietStdout quiet;
+        TaskStore store;
+        store.tasks = loadTasks(store.arena);
+        addTask(store, "Benchmark task"); }, restore);
+    measure("add (ndjson, not loaded, end-to-end)" + suffix, ndjsonBytes, addUnloaded);
+
+    // The same store sharded, where a change rewrites one shard instead of the whole file.
+    // The status alternates so that every run changes the shard's bytes.
+    storeFormat = StoreFormat::Sharded;
+    saveTasks(tasks);
+    measure("loadTasks (sharded)" + suffix, ndjsonBytes, []
+            {
+        StringArena arena;
+        sink += loadTasks(arena).size(); });
+    bool markDone = true;
+    measure("mark-done (sharded, end-to-end)" + suffix, ndjsonBytes, [&]
+            {
+        QuietStdout quiet;
+        TaskStore store;
+        store.tasks = loadTasks(store.arena);
+        markTaskStatus(store, static_cast<int>(count / 2), markDone ? "done" : "todo");
+        markDone = !markDone; });
+    std::filesystem::remove_all(SHARD_DIR);
+    storeFormat = StoreFormat::JsonArray;
+
+    std::filesystem::remove(pristine);
+    std::filesystem::remove(META_FILE);
+    tasks.clear();
+    benchSearch(count);
+    benchStatus(count);
+}
+
+std::vector<size_t> parseSizes(const std::string &text)
+{
+    std::vector<size_t> sizes;
+    std::stringstream ss(text);
+    std::string item;
+    while (std::getline(ss, item, ','))
+    {
+        sizes.push_back(std::stoul(item));
+    }
+    return sizes;
+}
+
+int main(int argc, char *argv[])
+{
+    countAllocations = true;
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        if (arg == "--sizes" && i + 1 < argc)
+        {
+            options.sizes = parseSizes(argv[++i]);
+        }
+        else if (arg == "--min-time" && i + 1 < argc)
+        {
+            options.minSeconds = std::stod(argv[++i]);
+        }
+        else if (arg == "--filter" && i + 1 < argc)
+        {
+            options.filter = argv[++i];
+        }
+        else
+        {
+            std::cerr << "Usage: task-bench [--sizes 1000,100000] [--min-time <seconds>] [--filter <name>]" << std::endl;
+            return 1;
+        }
+    }
+
+    // Store benchmarks read and write TASKS_FILE in the current directory, so use a scratch one.
+    // It gets a random name and must not exist yet, so nothing already there is removed at the
+    // end and concurrent runs do not share it.
+    std::filesystem::path scratch;
+    std::random_device random;
+    do
+    {
+        scratch = std::filesystem::temp_directory_path() / std::format("task-bench-{:08x}", random());
+    } while (!std::filesystem::create_directory(scratch));
+    std::filesystem::current_path(scratch);
+    parsedCacheEnabled = false;
+
+    benchJsonHelpers();
+    for (size_t count : options.sizes)
+    {
+        benchStore(count);
+    }
+
+    std::filesystem::current_path(scratch.parent_path());
+    std::filesystem::remove_all(scratch);
+    return sink == 0xFFFFFFFF; // Practically never true; keeps `sink` live
+}
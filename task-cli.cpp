@@ -24,669 +24,5484 @@
 #include <cctype>
 #include <format>
 #include <ranges>
+#include <memory>
+#include <memory_resource>
+#include <filesystem>
+#include <charconv>
+#include <string_view>
+#include <cstring>
+#include <bit>
+#include <optional>
+#include <cstdint>
+#include <span>
+#include <array>
+#include <cmath>
+#include <atomic>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <cstdlib>
+#include <set>
+
+#ifdef _WIN32
+#include <io.h>
+#include <malloc.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#endif
+
+// SIMD paths are compiled for x86 with GCC/Clang; everything else uses the scalar fallback.
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__) && defined(__SSE2__)
+#define TASK_CLI_X86_SIMD 1
+#include <immintrin.h>
+#else
+#define TASK_CLI_X86_SIMD 0
+#endif
 
 // --- Constants ---
 const std::string TASKS_FILE = "tasks.json";
+const std::string SHARD_DIR = TASKS_FILE + ".shards"; // Holds a sharded store instead of TASKS_FILE
+const std::string SHARD_MANIFEST = SHARD_DIR + "/manifest";
 
 // --- Forward Declarations ---
 class Task; // Forward declare Task class
-std::vector<Task> loadTasks();
-void saveTasks(const std::vector<Task> &tasks);
+class StringArena;
+struct SourceStamp;
+struct DerivedState;
+using TaskList = std::pmr::vector<Task>; // Allocates from the store's memory resource
+TaskList loadTasks(StringArena &arena, bool lazy = false, DerivedState *derived = nullptr);
+void saveTasks(const TaskList &tasks, DerivedState *derived = nullptr);
 std::string getCurrentTimestamp();
-std::string escapeJsonString(const std::string &input);
-std::string unescapeJsonString(const std::string &input);
-std::string findJsonValue(const std::string &objectStr, const std::string &key);
-int getNextId(const std::vector<Task> &tasks);
+std::string escapeJsonString(std::string_view input);
+std::string unescapeJsonString(std::string_view input);
+std::string_view findJsonValue(std::string_view objectStr, std::string_view key);
+int getNextId(const TaskList &tasks);
 void printUsage();
 
-// --- Task Class Definition ---
-class Task
+// --- Instrumentation ---
+// `--stats` reports where a command spent its time. Each PhaseTimer adds its wall time to one
+// phase; nested timers pause the enclosing one, so phase times are exclusive and add up to
+// the measured total. When stats are disabled a timer costs a single branch.
+
+enum class Phase
 {
-private:
-    int id;
-    std::string description;
-    std::string status; // "todo", "in-progress", "done"
-    std::string createdAt;
-    std::string updatedAt;
+    Read,
+    Parse,
+    IndexBuild,
+    Operation,
+    Serialize,
+    Write,
+    Fsync,
+    Count
+};
 
-    // Private helper to update the timestamp
-    void updateTimestamp()
+const char *const PHASE_NAMES[] = {"read", "parse", "index build", "operation", "serialize", "write", "fsync"};
+
+struct CommandStats
+{
+    bool enabled = false;
+    std::atomic<uint64_t> phaseNs[static_cast<size_t>(Phase::Count)] = {};
+    std::atomic<uint64_t> bytesRead{0};
+    std::atomic<uint64_t> bytesWritten{0};
+};
+
+CommandStats commandStats;
+
+// Heap allocations made by the process, counted by the replaced global operator new below.
+// Counting costs two atomic adds per allocation, so it only happens once `countAllocations`
+// is set (by --stats, or by task-bench).
+bool countAllocations = false;
+std::atomic<uint64_t> allocationCount{0};
+std::atomic<uint64_t> allocationBytes{0};
+
+void countAllocation(std::size_t size)
+{
+    if (countAllocations)
     {
-        updatedAt = getCurrentTimestamp();
+        allocationCount.fetch_add(1, std::memory_order_relaxed);
+        allocationBytes.fetch_add(size, std::memory_order_relaxed);
     }
+}
 
-public:
-    // Constructor for creating new tasks programmatically
-    Task(int taskId, const std::string &taskDescription) : id(taskId),
-                                                           description(taskDescription),
-                                                           status("todo") // New tasks default to 'todo'
+void *countedAllocate(std::size_t size)
+{
+    countAllocation(size);
+    if (void *p = std::malloc(size == 0 ? 1 : size))
     {
-        createdAt = getCurrentTimestamp();
-        updatedAt = createdAt; // Initially the same
+        return p;
     }
+    throw std::bad_alloc();
+}
 
-    // Default constructor: Needed for creating Task objects before populating from file
-    Task() : id(0), status("todo") {}
+void *operator new(std::size_t size) { return countedAllocate(size); }
+void *operator new[](std::size_t size) { return countedAllocate(size); }
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete[](void *p) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void *p, std::size_t) noexcept { std::free(p); }
 
-    ~Task() {} // Destructor (not strictly necessary here, but good practice)
+// Over-aligned requests, which std::pmr::new_delete_resource() always makes
+void *countedAllocate(std::size_t size, std::align_val_t alignment)
+{
+    countAllocation(size);
+    size_t align = static_cast<size_t>(alignment);
+#ifdef _WIN32
+    void *p = _aligned_malloc(size == 0 ? 1 : size, align);
+#else
+    void *p = std::aligned_alloc(align, (size + align - 1) / align * align); // Size must be a multiple of the alignment
+#endif
+    if (p == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+    return p;
+}
 
-    // --- Getters (provide read access) ---
-    int getID() const { return id; }
-    const std::string &getDescription() const { return description; }
-    const std::string &getStatus() const { return status; }
-    const std::string &getCreatedAt() const { return createdAt; }
-    const std::string &getUpdatedAt() const { return updatedAt; }
+void countedFree(void *p, std::align_val_t) noexcept
+{
+#ifdef _WIN32
+    _aligned_free(p);
+#else
+    std::free(p);
+#endif
+}
 
-    // --- Setters (provide controlled write access) ---
+void *operator new(std::size_t size, std::align_val_t alignment) { return countedAllocate(size, alignment); }
+void *operator new[](std::size_t size, std::align_val_t alignment) { return countedAllocate(size, alignment); }
+void operator delete(void *p, std::align_val_t alignment) noexcept { countedFree(p, alignment); }
+void operator delete[](void *p, std::align_val_t alignment) noexcept { countedFree(p, alignment); }
+void operator delete(void *p, std::size_t, std::align_val_t alignment) noexcept { countedFree(p, alignment); }
+void operator delete[](void *p, std::size_t, std::align_val_t alignment) noexcept { countedFree(p, alignment); }
 
-    // Sets description and updates the timestamp
-    void setDescription(const std::string &newDescription)
+// `--trace <file>` records scoped spans and writes them as Chrome trace-event JSON, which
+// chrome://tracing and ui.perfetto.dev can open. Spans are thread-aware so parallel work
+// shows up on separate tracks. When tracing is disabled a span costs a single branch.
+
+struct TraceEvent
+{
+    const char *name;
+    uint32_t threadId;
+    double startUs;
+    double durationUs;
+};
+
+struct TraceRecorder
+{
+    bool enabled = false;
+    std::string path;
+    std::chrono::steady_clock::time_point origin = std::chrono::steady_clock::now();
+    std::mutex mutex;
+    std::vector<TraceEvent> events;
+    std::set<std::string, std::less<>> names; // Copies made by intern()
+    std::atomic<uint32_t> nextThreadId{1};
+
+    uint32_t currentThreadId()
     {
-        description = newDescription;
-        updateTimestamp();
+        thread_local uint32_t id = nextThreadId.fetch_add(1);
+        return id;
     }
 
-    // Sets status (with validation) and updates the timestamp
-    void setStatus(const std::string &newStatus)
+    double microsSinceOrigin(std::chrono::steady_clock::time_point t) const
+    {
+        return std::chrono::duration<double, std::micro>(t - origin).count();
+    }
+
+    // Returns a copy of `name` that lives as long as the recorder, for span names whose own
+    // storage does not (such as the command of a batch line)
+    const char *intern(std::string_view name)
     {
-        if (newStatus == "todo" || newStatus == "in-progress" || newStatus == "done")
+        if (!enabled)
         {
-            status = newStatus;
-            updateTimestamp();
+            return "";
         }
-        else
+        std::lock_guard<std::mutex> lock(mutex);
+        return names.emplace(name).first->c_str();
+    }
+
+    void record(const char *name, std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end)
+    {
+        TraceEvent event{name, currentThreadId(), microsSinceOrigin(start), microsSinceOrigin(end) - microsSinceOrigin(start)};
+        std::lock_guard<std::mutex> lock(mutex);
+        events.push_back(event);
+    }
+
+    // Writes the collected spans as {"traceEvents": [...]} complete ("X") events
+    bool write()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::ofstream file(path, std::ios::binary);
+        if (!file.is_open())
         {
-            // Keep original status or handle error differently if needed
-            std::cerr << "Warning: Invalid status '" << newStatus << "' for task " << id
-                      << ". Status must be 'todo', 'in-progress', or 'done'. Status not changed." << std::endl;
+            std::cerr << "Error: Could not open trace file " << path << " for writing." << std::endl;
+            return false;
+        }
+        file << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+        for (size_t i = 0; i < events.size(); ++i)
+        {
+            const TraceEvent &e = events[i];
+            file << std::format("  {{\"name\": \"{}\", \"cat\": \"task-cli\", \"ph\": \"X\", \"pid\": 1, \"tid\": {}, "
+                                "\"ts\": {:.3f}, \"dur\": {:.3f}}}{}\n",
+                                escapeJsonString(e.name), e.threadId, e.startUs, e.durationUs, i + 1 < events.size() ? "," : "");
         }
+        file << "]}\n";
+        return file.good();
     }
-
-    // Grant `loadTasks` direct access to private members.
-    // This avoids needing public 'internalSet' methods just for loading.
-    friend std::vector<Task> loadTasks();
 };
 
-// --- Helper Functions ---
+TraceRecorder traceRecorder;
 
-// Get current timestamp as string
-std::string getCurrentTimestamp()
+// Records one span covering its own lifetime. `name` must outlive the recorder (string literals
+// or TraceRecorder::intern() results).
+class TraceSpan
 {
-    auto now = std::chrono::system_clock::now();
-    auto now_c = std::chrono::system_clock::to_time_t(now);
-    std::stringstream ss;
-    ss << std::put_time(std::localtime(&now_c), "%Y-%m-%d %H:%M:%S");
-    return ss.str();
-}
+public:
+    explicit TraceSpan(const char *name) : name(name)
+    {
+        if (traceRecorder.enabled)
+        {
+            start = std::chrono::steady_clock::now();
+        }
+    }
 
-// Basic JSON string escaping
-std::string escapeJsonString(const std::string &input)
-{
-    std::string output;
-    output.reserve(input.length());
-    for (char c : input)
+    ~TraceSpan()
     {
-        switch (c)
+        if (traceRecorder.enabled && start != std::chrono::steady_clock::time_point{})
         {
-        case '"':
-            output += "\\\"";
-            break;
-        case '\\':
-            output += "\\\\";
-            break;
-        // Add more escapes if needed (e.g., \n, \r, \t, \b, \f)
-        // case '\n': output += "\\n"; break;
-        // case '\r': output += "\\r"; break;
-        // case '\t': output += "\\t"; break;
-        // case '\b': output += "\\b"; break;
-        // case '\f': output += "\\f"; break;
-        default:
-            output += c;
-            break;
+            traceRecorder.record(name, start, std::chrono::steady_clock::now());
         }
     }
-    return output;
-}
 
-// Basic JSON string unescaping
-std::string unescapeJsonString(const std::string &input)
+    TraceSpan(const TraceSpan &) = delete;
+    TraceSpan &operator=(const TraceSpan &) = delete;
+
+private:
+    const char *name;
+    std::chrono::steady_clock::time_point start{};
+};
+
+class PhaseTimer
 {
-    std::string output;
-    output.reserve(input.length());
-    bool escaped = false;
-    for (char c : input)
+public:
+    explicit PhaseTimer(Phase phase) : phase(phase), span(PHASE_NAMES[static_cast<size_t>(phase)])
     {
-        if (escaped)
+        if (!commandStats.enabled)
         {
-            switch (c)
-            {
-            case '"':
-                output += '"';
-                break;
-            case '\\':
-                output += '\\';
-                break;
-            // Add more unescapes corresponding to escapes above
-            // case 'n': output += '\n'; break;
-            // case 'r': output += '\r'; break;
-            // case 't': output += '\t'; break;
-            // case 'b': output += '\b'; break;
-            // case 'f': output += '\f'; break;
-            default:
-                output += '\\';
-                output += c;
-                break; // Keep unrecognized escapes
-            }
-            escaped = false;
+            return;
         }
-        else
+        auto now = std::chrono::steady_clock::now();
+        parent = current;
+        if (parent != nullptr)
         {
-            if (c == '\\')
-            {
-                escaped = true;
-            }
-            else
-            {
-                output += c;
-            }
+            parent->accumulate(now); // Pause the enclosing phase
         }
+        start = now;
+        current = this;
     }
-    return output;
-}
 
-// Helper to find the value associated with a key in a JSON object string segment
-std::string findJsonValue(const std::string &objectStr, const std::string &key)
-{
-    std::string keyPattern = "\"" + key + "\":";
-    size_t keyPos = objectStr.find(keyPattern);
-    if (keyPos == std::string::npos)
+    ~PhaseTimer()
     {
-        return ""; // Key not found
+        if (!commandStats.enabled || current != this)
+        {
+            return;
+        }
+        auto now = std::chrono::steady_clock::now();
+        accumulate(now);
+        current = parent;
+        if (parent != nullptr)
+        {
+            parent->start = now; // Resume it
+        }
     }
 
-    size_t valueStart = keyPos + keyPattern.length();
+    PhaseTimer(const PhaseTimer &) = delete;
+    PhaseTimer &operator=(const PhaseTimer &) = delete;
 
-    // Skip whitespace
-    while (valueStart < objectStr.length() && std::isspace(static_cast<unsigned char>(objectStr[valueStart])))
+private:
+    Phase phase;
+    TraceSpan span; // Every phase also shows up in --trace output
+    PhaseTimer *parent = nullptr;
+    std::chrono::steady_clock::time_point start;
+    static thread_local PhaseTimer *current;
+
+    void accumulate(std::chrono::steady_clock::time_point now)
     {
-        valueStart++;
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(now - start).count();
+        commandStats.phaseNs[static_cast<size_t>(phase)].fetch_add(static_cast<uint64_t>(ns), std::memory_order_relaxed);
     }
+};
 
-    if (valueStart >= objectStr.length())
-        return ""; // No value found
+thread_local PhaseTimer *PhaseTimer::current = nullptr;
 
-    if (objectStr[valueStart] == '"')
-    { // String value
-        size_t valueEnd = valueStart + 1;
-        bool inEscape = false;
-        while (valueEnd < objectStr.length())
+// Prints the collected stats to stderr, as text or as a JSON object
+void reportCommandStats(double totalMs, size_t taskCount, size_t storePeakBytes, bool json)
+{
+    auto ms = [](Phase phase)
+    { return static_cast<double>(commandStats.phaseNs[static_cast<size_t>(phase)].load()) / 1e6; };
+
+    if (json)
+    {
+        std::string phases;
+        for (size_t i = 0; i < static_cast<size_t>(Phase::Count); ++i)
         {
-            if (inEscape)
-            {
-                inEscape = false; // Consume the escaped character
-            }
-            else if (objectStr[valueEnd] == '\\')
-            {
-                inEscape = true;
-            }
-            else if (objectStr[valueEnd] == '"')
-            {
-                // Found the closing quote
-                return unescapeJsonString(objectStr.substr(valueStart + 1, valueEnd - valueStart - 1));
-            }
-            valueEnd++;
+            phases += std::format("{}\"{}\": {:.3f}", i == 0 ? "" : ", ", PHASE_NAMES[i], ms(static_cast<Phase>(i)));
         }
-        // If loop finishes without finding closing quote, it's malformed
-        std::cerr << "Warning: Malformed JSON string value found for key '" << key << "'" << std::endl;
-        return ""; // Malformed string
+        std::cerr << std::format("{{\"phasesMs\": {{{}}}, \"totalMs\": {:.3f}, \"bytesRead\": {}, \"bytesWritten\": {}, "
+                                 "\"tasks\": {}, \"allocations\": {}, \"allocatedBytes\": {}, \"storePeakBytes\": {}}}\n",
+                                 phases, totalMs, commandStats.bytesRead.load(), commandStats.bytesWritten.load(),
+                                 taskCount, allocationCount.load(), allocationBytes.load(), storePeakBytes);
+        return;
     }
-    else
-    { // Assume number (or potentially bool/null, but we only need numbers here)
-        size_t valueEnd = valueStart;
-        // Find the end based on comma or closing brace
-        size_t commaPos = objectStr.find(',', valueStart);
-        size_t bracePos = objectStr.find('}', valueStart);
 
-        // Determine the actual end position
-        if (commaPos != std::string::npos && bracePos != std::string::npos)
+    std::cerr << "\n--- Command Stats ---" << std::endl;
+    for (size_t i = 0; i < static_cast<size_t>(Phase::Count); ++i)
+    {
+        std::cerr << std::format("  {:<14} {:>10.3f} ms\n", std::string(PHASE_NAMES[i]) + ":", ms(static_cast<Phase>(i)));
+    }
+    std::cerr << std::format("  {:<14} {:>10.3f} ms\n", "total:", totalMs);
+    std::cerr << std::format("  bytes read:    {}\n"
+                             "  bytes written: {}\n"
+                             "  tasks:         {}\n"
+                             "  allocations:   {} ({} bytes)\n"
+                             "  store peak:    {} bytes\n",
+                             commandStats.bytesRead.load(), commandStats.bytesWritten.load(), taskCount,
+                             allocationCount.load(), allocationBytes.load(), storePeakBytes);
+}
+
+// --- Memory Resources ---
+// Store containers allocate from a std::pmr::memory_resource chosen per invocation (see
+// main): a monotonic buffer for read-only commands, which never free until exit, and a pool
+// for long-running batch mode. Both sit on top of a CountingResource, which measures what
+// the store uses and can cap it (--mem-cap).
+
+// Forwards to an upstream resource while tracking bytes in use and the peak. Allocations that
+// would exceed the cap throw std::bad_alloc, just like an exhausted upstream would.
+class CountingResource : public std::pmr::memory_resource
+{
+public:
+    explicit CountingResource(std::pmr::memory_resource *upstream = std::pmr::new_delete_resource(),
+                              size_t cap = std::numeric_limits<size_t>::max())
+        : upstream(upstream), cap(cap)
+    {
+    }
+
+    size_t bytesInUse() const { return inUse.load(std::memory_order_relaxed); }
+    size_t peakBytes() const { return peak.load(std::memory_order_relaxed); }
+    size_t capBytes() const { return cap; }
+
+private:
+    std::pmr::memory_resource *upstream;
+    size_t cap;
+    std::atomic<size_t> inUse{0};
+    std::atomic<size_t> peak{0};
+
+    void *do_allocate(size_t bytes, size_t alignment) override
+    {
+        size_t now = inUse.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+        if (now > cap)
         {
-            valueEnd = std::min(commaPos, bracePos);
+            inUse.fetch_sub(bytes, std::memory_order_relaxed);
+            throw std::bad_alloc();
         }
-        else if (commaPos != std::string::npos)
+        void *p = upstream->allocate(bytes, alignment);
+        size_t seen = peak.load(std::memory_order_relaxed);
+        while (now > seen && !peak.compare_exchange_weak(seen, now, std::memory_order_relaxed))
         {
-            valueEnd = commaPos;
         }
-        else if (bracePos != std::string::npos)
+        return p;
+    }
+
+    void do_deallocate(void *p, size_t bytes, size_t alignment) override
+    {
+        upstream->deallocate(p, bytes, alignment);
+        inUse.fetch_sub(bytes, std::memory_order_relaxed);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override
+    {
+        return this == &other;
+    }
+};
+
+// Parses a byte count with an optional K/M/G suffix (powers of 1024), e.g. "512M". Counts
+// that do not fit in size_t are rejected.
+std::optional<size_t> parseByteSize(std::string_view text)
+{
+    size_t multiplier = 1;
+    if (!text.empty())
+    {
+        switch (std::toupper(static_cast<unsigned char>(text.back())))
         {
-            valueEnd = bracePos;
+        case 'K':
+            multiplier = size_t{1} << 10;
+            break;
+        case 'M':
+            multiplier = size_t{1} << 20;
+            break;
+        case 'G':
+            multiplier = size_t{1} << 30;
+            break;
         }
-        else
+        if (multiplier != 1)
         {
-            // Should not happen in valid JSON within an object, but handle defensively
-            valueEnd = objectStr.length();
+            text.remove_suffix(1);
         }
+    }
+    if (text.empty() || text.size() > 12 || !std::ranges::all_of(text, [](char c) { return std::isdigit(static_cast<unsigned char>(c)) != 0; }))
+    {
+        return std::nullopt;
+    }
+    uint64_t value = 0;
+    auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+    if (error != std::errc{} || end != text.data() + text.size() || value > std::numeric_limits<size_t>::max() / multiplier)
+    {
+        return std::nullopt; // Too large to be a cap, rather than wrapping to a smaller one
+    }
+    return static_cast<size_t>(value) * multiplier;
+}
 
-        // Extract the potential number part
-        std::string numStr = objectStr.substr(valueStart, valueEnd - valueStart);
+// --- String Storage ---
 
-        // Trim trailing whitespace from the extracted part
-        size_t lastChar = numStr.find_last_not_of(" \t\n\r\f\v");
-        if (lastChar == std::string::npos)
-        {
-            return ""; // Empty value
-        }
-        numStr = numStr.substr(0, lastChar + 1);
+// Bump allocator for the string payloads of one loaded store. loadTasks() reserves a block
+// the size of the file up front, so loading allocates once no matter how many tasks there
+// are. Blocks come from the store's memory resource and are released all at once when the
+// arena is destroyed; views handed out stay valid until then.
+class StringArena
+{
+public:
+    explicit StringArena(std::pmr::memory_resource *resource = std::pmr::get_default_resource())
+        : upstream(resource), blocks(resource)
+    {
+    }
 
-        // Basic validation: check if it looks like a number (digits, optionally negative)
-        bool is_num = !numStr.empty();
-        for (size_t i = 0; i < numStr.length(); ++i)
-        {
-            if (i == 0 && numStr[i] == '-')
-                continue; // Allow leading minus
-            if (!std::isdigit(static_cast<unsigned char>(numStr[i])))
-            {
-                is_num = false;
-                break;
-            }
-        }
-        if (is_num)
+    StringArena(const StringArena &) = delete;
+    StringArena &operator=(const StringArena &) = delete;
+
+    ~StringArena()
+    {
+        for (const auto &block : blocks)
         {
-            return numStr;
+            upstream->deallocate(block.data(), block.size(), 1);
         }
-        else
+    }
+
+    std::pmr::memory_resource *resource() const { return upstream; }
+
+    // Makes sure the next `bytes` bytes can be stored without another allocation
+    void reserve(size_t bytes)
+    {
+        if (bytes > remaining)
         {
-            std::cerr << "Warning: Non-numeric value found for numeric key '" << key << "': " << numStr << std::endl;
-            return "";
+            addBlock(bytes);
         }
     }
-}
 
-// --- JSON Loading (using friend access) ---
-std::vector<Task> loadTasks()
-{
-    std::vector<Task> tasks;
-    std::ifstream file(TASKS_FILE);
+    // Uninitialized space for `bytes` bytes, valid as long as the arena
+    char *allocate(size_t bytes)
+    {
+        reserve(bytes);
+        char *destination = cursor;
+        cursor += bytes;
+        remaining -= bytes;
+        return destination;
+    }
 
-    if (!file.is_open())
+    std::string_view store(std::string_view text)
     {
-        // File doesn't exist is not an error, just means no tasks yet.
-        return tasks;
+        char *destination = allocate(text.size());
+        std::memcpy(destination, text.data(), text.size());
+        return {destination, text.size()};
     }
 
-    std::stringstream buffer;
-    buffer << file.rdbuf();
-    std::string content = buffer.str();
-    file.close();
+private:
+    static constexpr size_t MIN_BLOCK_SIZE = 64 * 1024;
+
+    std::pmr::memory_resource *upstream;
+    std::pmr::vector<std::span<char>> blocks;
+    char *cursor = nullptr;
+    size_t remaining = 0;
 
-    // Basic check for empty or just whitespace content
-    if (content.find_first_not_of(" \t\n\r\f\v") == std::string::npos)
+    void addBlock(size_t atLeast)
     {
-        return tasks;
+        size_t size = std::max(atLeast, MIN_BLOCK_SIZE);
+        cursor = static_cast<char *>(upstream->allocate(size, 1));
+        blocks.emplace_back(cursor, size);
+        remaining = size;
     }
+};
 
-    // Trim leading/trailing whitespace just in case
-    content.erase(0, content.find_first_not_of(" \t\n\r\f\v"));
-    content.erase(content.find_last_not_of(" \t\n\r\f\v") + 1);
+// A string field of a Task: either borrowed from the StringArena the task was loaded into,
+// or an owned heap copy once the field is set after loading. 16 bytes instead of the 32 of
+// a std::string, and no allocation for loaded tasks.
+class TaskText
+{
+public:
+    TaskText() = default;
 
-    if (content.empty() || content == "[]")
+    // Refers to text without copying; the caller keeps it alive (arena-backed)
+    static TaskText borrowed(std::string_view text)
     {
-        return tasks; // Empty file or empty JSON array
+        TaskText result;
+        result.data = text.data();
+        result.length = checkedLength(text);
+        return result;
     }
 
-    // Very basic array parsing: find '[' and ']'
-    size_t startPos = content.find('[');
-    size_t endPos = content.rfind(']');
-    if (startPos == std::string::npos || endPos == std::string::npos || startPos >= endPos)
+    static TaskText copied(std::string_view text)
     {
-        std::cerr << "Error: Invalid JSON format in " << TASKS_FILE << " (missing or misplaced array brackets)." << std::endl;
-        return tasks; // Return empty on major format error
+        TaskText result;
+        result.assignCopy(text);
+        return result;
     }
 
-    size_t currentPos = startPos + 1;
-    while (currentPos < endPos)
+    TaskText(const TaskText &other) : data(other.data), length(other.length)
     {
-        size_t objStart = content.find('{', currentPos);
-        if (objStart == std::string::npos || objStart >= endPos)
-            break; // No more objects
-
-        size_t objEnd = content.find('}', objStart + 1);
-        // Basic brace balancing check (doesn't handle nested objects)
-        size_t nextObjStart = content.find('{', objStart + 1);
-        if (objEnd == std::string::npos || (nextObjStart != std::string::npos && objEnd > nextObjStart) || objEnd >= endPos)
+        if (other.owned)
         {
-            std::cerr << "Error: Invalid JSON format in " << TASKS_FILE << " (mismatched or nested braces detected by simple check)." << std::endl;
-            // Attempt to recover might be complex, safer to stop parsing here
-            break;
+            assignCopy(other.view());
         }
+    }
+
+    TaskText(TaskText &&other) noexcept : data(other.data), length(other.length), owned(other.owned)
+    {
+        other.data = "";
+        other.length = 0;
+        other.owned = false;
+    }
 
-        std::string objectStr = content.substr(objStart + 1, objEnd - objStart - 1);
+    TaskText &operator=(TaskText other) noexcept
+    {
+        std::swap(data, other.data);
+        std::swap(length, other.length);
+        std::swap(owned, other.owned);
+        return *this;
+    }
 
-        Task task; // Create default task object
-        bool taskValid = true;
-        try
+    ~TaskText()
+    {
+        if (owned)
         {
-            std::string idStr = findJsonValue(objectStr, "id");
-            std::string descStr = findJsonValue(objectStr, "description");
-            std::string statusStr = findJsonValue(objectStr, "status");
-            std::string createdStr = findJsonValue(objectStr, "createdAt");
-            std::string updatedStr = findJsonValue(objectStr, "updatedAt");
+            delete[] data;
+        }
+    }
 
-            // Basic validation of extracted values
-            if (idStr.empty())
-            {
-                std::cerr << "Warning: Skipping task due to missing or invalid ID." << std::endl;
-                taskValid = false;
-            }
-            else
-            {
-                task.id = std::stoi(idStr); // Use friend access
-            }
+    std::string_view view() const { return {data, length}; }
 
-            if (descStr.empty())
-            {
-                std::cerr << "Warning: Skipping task ID " << task.id << " due to missing description." << std::endl;
-                taskValid = false;
-            }
-            else
-            {
-                task.description = descStr; // Use friend access
-            }
+private:
+    const char *data = "";
+    uint32_t length = 0;
+    bool owned = false;
 
-            if (statusStr.empty() || (statusStr != "todo" && statusStr != "in-progress" && statusStr != "done"))
-            {
-                std::cerr << "Warning: Skipping task ID " << task.id << " due to missing or invalid status: '" << statusStr << "'" << std::endl;
-                taskValid = false;
-            }
-            else
-            {
-                task.status = statusStr; // Use friend access
-            }
+    static uint32_t checkedLength(std::string_view text)
+    {
+        if (text.size() > std::numeric_limits<uint32_t>::max())
+        {
+            throw std::length_error("Task text longer than 4 GiB.");
+        }
+        return static_cast<uint32_t>(text.size());
+    }
 
-            if (createdStr.empty())
-            {
-                std::cerr << "Warning: Skipping task ID " << task.id << " due to missing createdAt." << std::endl;
-                taskValid = false;
-            }
-            else
-            {
-                task.createdAt = createdStr; // Use friend access
+    void assignCopy(std::string_view text)
+    {
+        length = checkedLength(text);
+        char *copy = new char[text.size()];
+        std::memcpy(copy, text.data(), text.size());
+        data = copy;
+        owned = true;
+    }
+};
+
+enum class TaskStatus : uint8_t
+{
+    Todo,
+    InProgress,
+    Done
+};
+
+constexpr std::string_view STATUS_NAMES[] = {"todo", "in-progress", "done"};
+
+// Length of the longest status name. Status values are written padded to it (see padTo).
+constexpr size_t STATUS_WIDTH = []
+{
+    size_t width = 0;
+    for (std::string_view name : STATUS_NAMES)
+    {
+        width = std::max(width, name.size());
+    }
+    return width;
+}();
+
+std::string_view statusName(TaskStatus status)
+{
+    return STATUS_NAMES[static_cast<size_t>(status)];
+}
+
+std::optional<TaskStatus> parseStatus(std::string_view name)
+{
+    for (size_t i = 0; i < std::size(STATUS_NAMES); ++i)
+    {
+        if (name == STATUS_NAMES[i])
+        {
+            return static_cast<TaskStatus>(i);
+        }
+    }
+    return std::nullopt;
+}
+
+// How a task field is stored in JSON and parsed back
+enum class FieldCodec : uint8_t
+{
+    Id,     // Bare integer, parsed with parseTaskId
+    Status, // Status name as a JSON string
+    Text    // Escaped JSON string, decoded into a TaskText
+};
+
+// One serialized field of Task (see Task::fieldTable)
+struct TaskFieldDescriptor
+{
+    std::string_view name;
+    FieldCodec codec;
+    TaskText Task::*text = nullptr; // Text fields: the member, and its bit in Task::pendingFields
+    uint8_t pendingFlag = 0;
+    // Values shorter than this are followed by spaces after the closing quote, so that any
+    // other value fits in their place (see patchTaskStatus)
+    uint8_t padTo = 0;
+};
+
+// --- Task Class Definition ---
+class Task
+{
+private:
+    // String fields a lazy load (see loadTasks) leaves undecoded until first access
+    enum PendingField : uint8_t
+    {
+        PENDING_DESCRIPTION = 1,
+        PENDING_CREATED_AT = 2,
+        PENDING_UPDATED_AT = 4
+    };
+
+    int id;
+    TaskStatus status; // todo, in-progress, done
+    mutable uint8_t pendingFields = 0;
+    mutable TaskText description;
+    mutable TaskText createdAt;
+    mutable TaskText updatedAt;
+
+    // Private helper to update the timestamp
+    void updateTimestamp()
+    {
+        updatedAt = TaskText::copied(getCurrentTimestamp());
+        pendingFields &= ~PENDING_UPDATED_AT;
+    }
+
+    // A pending field still holds the raw JSON text from the file buffer. Escape-free values
+    // (almost all) are already their decoded form; escaped ones are decoded into an owned copy
+    // on first access, since there is no arena at hand here.
+    const TaskText &decoded(TaskText &field, uint8_t flag) const
+    {
+        if (pendingFields & flag)
+        {
+            pendingFields &= ~flag;
+            std::string_view raw = field.view();
+            if (raw.find('\\') != std::string_view::npos)
+            {
+                field = TaskText::copied(unescapeJsonString(raw));
+            }
+        }
+        return field;
+    }
+
+public:
+    // Constructor for creating new tasks programmatically
+    Task(int taskId, const std::string &taskDescription) : id(taskId),
+                                                           status(TaskStatus::Todo), // New tasks default to 'todo'
+                                                           description(TaskText::copied(taskDescription))
+    {
+        createdAt = TaskText::copied(getCurrentTimestamp());
+        updatedAt = createdAt; // Initially the same
+    }
+
+    // Constructor for tasks whose fields are all known up front (e.g. generated stores)
+    Task(int taskId, const std::string &taskDescription, TaskStatus taskStatus,
+         const std::string &taskCreatedAt, const std::string &taskUpdatedAt) : id(taskId),
+                                                                              status(taskStatus),
+                                                                              description(TaskText::copied(taskDescription)),
+                                                                              createdAt(TaskText::copied(taskCreatedAt)),
+                                                                              updatedAt(TaskText::copied(taskUpdatedAt))
+    {
+    }
+
+    // Default constructor: Needed for creating Task objects before populating from file
+    Task() : id(0), status(TaskStatus::Todo) {}
+
+    ~Task() {} // Destructor (not strictly necessary here, but good practice)
+
+    // The user-declared destructor would otherwise suppress the (cheap) implicit moves
+    Task(const Task &) = default;
+    Task(Task &&) noexcept = default;
+    Task &operator=(const Task &) = default;
+    Task &operator=(Task &&) noexcept = default;
+
+    // The fields written to and read from tasks.json, in file order. loadTasks, saveTasks and
+    // the canonical-layout matcher are all driven by this table.
+    static constexpr size_t FIELD_COUNT = 5;
+    static constexpr std::array<TaskFieldDescriptor, FIELD_COUNT> fieldTable()
+    {
+        return {{{"id", FieldCodec::Id},
+                 {"description", FieldCodec::Text, &Task::description, PENDING_DESCRIPTION},
+                 {"status", FieldCodec::Status, nullptr, 0, STATUS_WIDTH},
+                 {"createdAt", FieldCodec::Text, &Task::createdAt, PENDING_CREATED_AT},
+                 {"updatedAt", FieldCodec::Text, &Task::updatedAt, PENDING_UPDATED_AT}}};
+    }
+
+    // --- Getters (provide read access) ---
+    // String views stay valid while the task and the arena it was loaded into are alive.
+    int getID() const { return id; }
+    std::string_view getDescription() const { return decoded(description, PENDING_DESCRIPTION).view(); }
+    TaskStatus getStatusCode() const { return status; }
+    std::string_view getStatus() const { return statusName(status); }
+    std::string_view getCreatedAt() const { return decoded(createdAt, PENDING_CREATED_AT).view(); }
+    std::string_view getUpdatedAt() const { return decoded(updatedAt, PENDING_UPDATED_AT).view(); }
+    // Text field by descriptor; the members are mutable, which a member pointer cannot see through
+    std::string_view getText(const TaskFieldDescriptor &field) const
+    {
+        return decoded(const_cast<Task *>(this)->*field.text, field.pendingFlag).view();
+    }
+
+    // --- Setters (provide controlled write access) ---
+
+    // Sets description and updates the timestamp
+    void setDescription(const std::string &newDescription)
+    {
+        description = TaskText::copied(newDescription);
+        pendingFields &= ~PENDING_DESCRIPTION;
+        updateTimestamp();
+    }
+
+    // Sets status (with validation) and updates the timestamp
+    void setStatus(const std::string &newStatus)
+    {
+        if (auto parsed = parseStatus(newStatus))
+        {
+            status = *parsed;
+            updateTimestamp();
+        }
+        else
+        {
+            // Keep original status or handle error differently if needed
+            std::cerr << "Warning: Invalid status '" << newStatus << "' for task " << id
+                      << ". Status must be 'todo', 'in-progress', or 'done'. Status not changed." << std::endl;
+        }
+    }
+
+    // Grant the loaders direct access to private members.
+    // This avoids needing public 'internalSet' methods just for loading.
+    friend bool buildTask(const std::array<std::string_view, FIELD_COUNT> &fields, StringArena &arena, bool lazy, Task &task);
+    friend bool loadTaskCache(const SourceStamp &source, StringArena &arena, TaskList &tasks, DerivedState &derived);
+};
+
+// --- Task Field Table ---
+// Everything derived from Task::fieldTable() is computed at compile time: key lookup by a
+// perfect hash, and the exact bytes saveTasks writes in front of each value.
+
+constexpr auto TASK_FIELDS = Task::fieldTable();
+constexpr size_t TASK_FIELD_COUNT = TASK_FIELDS.size();
+
+constexpr bool isQuoted(FieldCodec codec) { return codec != FieldCodec::Id; }
+
+// Length plus first byte separates the current key names; the static_assert below catches a
+// collision when a field is added, and the mix can then be changed here.
+constexpr size_t FIELD_SLOT_COUNT = 8;
+constexpr size_t fieldSlot(std::string_view key)
+{
+    return (key.size() + static_cast<unsigned char>(key.front())) % FIELD_SLOT_COUNT;
+}
+
+constexpr uint8_t NO_FIELD = 0xFF;
+constexpr std::array<uint8_t, FIELD_SLOT_COUNT> FIELD_SLOTS = []
+{
+    std::array<uint8_t, FIELD_SLOT_COUNT> slots{};
+    slots.fill(NO_FIELD);
+    for (size_t i = 0; i < TASK_FIELD_COUNT; ++i)
+    {
+        slots[fieldSlot(TASK_FIELDS[i].name)] = static_cast<uint8_t>(i);
+    }
+    return slots;
+}();
+
+static_assert(std::ranges::all_of(TASK_FIELDS, [](const TaskFieldDescriptor &field)
+                                  { return TASK_FIELDS[FIELD_SLOTS[fieldSlot(field.name)]].name == field.name; }),
+              "Task field names collide in fieldSlot()");
+
+// Index of the field named `key` in TASK_FIELDS, or NO_FIELD for keys Task does not have
+inline uint8_t findTaskField(std::string_view key)
+{
+    if (key.empty())
+    {
+        return NO_FIELD;
+    }
+    uint8_t index = FIELD_SLOTS[fieldSlot(key)];
+    return (index != NO_FIELD && TASK_FIELDS[index].name == key) ? index : NO_FIELD;
+}
+
+// Index of the field named `name` in TASK_FIELDS, at compile time
+constexpr size_t taskFieldIndex(std::string_view name)
+{
+    size_t index = 0;
+    while (TASK_FIELDS[index].name != name)
+    {
+        index++; // Runs off the end, which is not a constant expression, if there is no such field
+    }
+    return index;
+}
+
+constexpr size_t ID_FIELD = taskFieldIndex("id");
+constexpr size_t STATUS_FIELD = taskFieldIndex("status");
+constexpr size_t UPDATED_AT_FIELD = taskFieldIndex("updatedAt");
+
+// What saveTasks writes before each value: separator, indentation, quoted key, colon, and the
+// opening quote of string values
+struct FieldPrefix
+{
+    std::array<char, 32> bytes{};
+    size_t size = 0;
+
+    constexpr std::string_view view() const { return {bytes.data(), size}; }
+};
+
+// The exact bytes of one task object in a store format, apart from the values themselves
+struct TaskLayout
+{
+    std::array<FieldPrefix, TASK_FIELD_COUNT> prefixes{};
+    std::string_view objectEnd; // After the last value (and its closing quote)
+};
+
+// `indent` goes in front of every key, `colon` after it
+constexpr TaskLayout makeTaskLayout(std::string_view indent, std::string_view colon, std::string_view objectEnd)
+{
+    TaskLayout layout{{}, objectEnd};
+    for (size_t i = 0; i < TASK_FIELD_COUNT; ++i)
+    {
+        FieldPrefix &prefix = layout.prefixes[i];
+        auto append = [&](std::string_view text)
+        {
+            for (char c : text)
+            {
+                prefix.bytes[prefix.size++] = c;
+            }
+        };
+        append(i == 0 ? "" : ",");
+        append(indent);
+        append("\"");
+        append(TASK_FIELDS[i].name);
+        append("\"");
+        append(colon);
+        append(isQuoted(TASK_FIELDS[i].codec) ? "\"" : "");
+    }
+    return layout;
+}
+
+// Pretty-printed objects inside the JSON array, one field per line
+constexpr TaskLayout ARRAY_LAYOUT = makeTaskLayout("\n    ", ": ", "\n  }");
+// Compact objects, one per line of an NDJSON store
+constexpr TaskLayout NDJSON_LAYOUT = makeTaskLayout("", ":", "}");
+
+// --- Store Formats ---
+// TASKS_FILE is either a pretty-printed JSON array or NDJSON: one compact task object per
+// line, which can be appended to without touching the rest of the file and split into
+// chunks at any newline. A sharded store replaces TASKS_FILE with a directory of NDJSON
+// files (see Sharded Store). loadTasks() detects the format and saveTasks() keeps it, so the
+// format is a property of the store; 'format' converts between them.
+
+enum class StoreFormat : uint8_t
+{
+    JsonArray,
+    Ndjson,
+    Sharded
+};
+
+StoreFormat storeFormat = StoreFormat::JsonArray; // Format of the loaded store, written back by saveTasks
+
+std::string_view formatName(StoreFormat format)
+{
+    switch (format)
+    {
+    case StoreFormat::Ndjson:
+        return "ndjson";
+    case StoreFormat::Sharded:
+        return "sharded";
+    default:
+        return "json";
+    }
+}
+
+// --- JSON Escaping ---
+// Descriptions are almost always plain text, so escaping is a scan for the next byte that
+// needs an escape followed by a bulk copy of the clean run before it. The scan is SIMD on
+// x86 (16/32 bytes per step) and picked at runtime like the substring scanners.
+
+// Returns the position of the first byte at or after `from` that must be escaped in a JSON
+// string ('"', '\\' or a control character below 0x20), or text.size() if there is none.
+using EscapeScanner = size_t (*)(std::string_view text, size_t from);
+
+inline bool needsJsonEscape(char c)
+{
+    return c == '"' || c == '\\' || static_cast<unsigned char>(c) < 0x20;
+}
+
+size_t findJsonEscapeScalar(std::string_view text, size_t from)
+{
+    while (from < text.size() && !needsJsonEscape(text[from]))
+    {
+        from++;
+    }
+    return from;
+}
+
+#if TASK_CLI_X86_SIMD
+size_t findJsonEscapeSse2(std::string_view text, size_t from)
+{
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i controlMax = _mm_set1_epi8(0x1F);
+    for (; from + 16 <= text.size(); from += 16)
+    {
+        const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(text.data() + from));
+        // max(byte, 0x1F) == 0x1F exactly for the control characters (unsigned compare)
+        const __m128i special = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(block, quote), _mm_cmpeq_epi8(block, backslash)),
+                                             _mm_cmpeq_epi8(_mm_max_epu8(block, controlMax), controlMax));
+        if (unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(special)))
+        {
+            return from + std::countr_zero(mask);
+        }
+    }
+    return findJsonEscapeScalar(text, from);
+}
+
+__attribute__((target("avx2"))) size_t findJsonEscapeAvx2(std::string_view text, size_t from)
+{
+    const __m256i quote = _mm256_set1_epi8('"');
+    const __m256i backslash = _mm256_set1_epi8('\\');
+    const __m256i controlMax = _mm256_set1_epi8(0x1F);
+    for (; from + 32 <= text.size(); from += 32)
+    {
+        const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(text.data() + from));
+        const __m256i special = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(block, quote), _mm256_cmpeq_epi8(block, backslash)),
+                                                _mm256_cmpeq_epi8(_mm256_max_epu8(block, controlMax), controlMax));
+        if (unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(special)))
+        {
+            return from + std::countr_zero(mask);
+        }
+    }
+    // g++ 12 at -O2 turns this call into a tail jmp with no vzeroupper in front of it
+    // (checked with objdump -d), leaving the SSE2 scan to run with dirty upper YMM halves
+    _mm256_zeroupper();
+    return findJsonEscapeSse2(text, from);
+}
+#endif
+
+// Picks the widest scanner the running CPU supports (checked once per process)
+EscapeScanner selectEscapeScanner()
+{
+#if TASK_CLI_X86_SIMD
+    static const EscapeScanner scanner = __builtin_cpu_supports("avx2") ? findJsonEscapeAvx2 : findJsonEscapeSse2;
+    return scanner;
+#else
+    return findJsonEscapeScalar;
+#endif
+}
+
+// Appends `input` to `out` escaped as the contents of a JSON string (RFC 8259). Control
+// characters use the short forms where JSON has one and \u00XX otherwise; everything else,
+// including UTF-8 sequences, is copied unchanged.
+void appendJsonEscaped(std::string &out, std::string_view input, EscapeScanner scan = selectEscapeScanner())
+{
+    static constexpr char HEX[] = "0123456789abcdef";
+    size_t pos = 0;
+    while (true)
+    {
+        size_t next = scan(input, pos);
+        out.append(input.data() + pos, next - pos);
+        if (next == input.size())
+        {
+            return;
+        }
+        char c = input[next];
+        switch (c)
+        {
+        case '"':
+            out += "\\\"";
+            break;
+        case '\\':
+            out += "\\\\";
+            break;
+        case '\b':
+            out += "\\b";
+            break;
+        case '\f':
+            out += "\\f";
+            break;
+        case '\n':
+            out += "\\n";
+            break;
+        case '\r':
+            out += "\\r";
+            break;
+        case '\t':
+            out += "\\t";
+            break;
+        default:
+            out += "\\u00";
+            out += HEX[(c >> 4) & 0xF];
+            out += HEX[c & 0xF];
+            break;
+        }
+        pos = next + 1;
+    }
+}
+
+// --- Helper Functions ---
+
+// Get current timestamp as string
+std::string getCurrentTimestamp()
+{
+    auto now = std::chrono::system_clock::now();
+    auto now_c = std::chrono::system_clock::to_time_t(now);
+    std::stringstream ss;
+    ss << std::put_time(std::localtime(&now_c), "%Y-%m-%d %H:%M:%S");
+    return ss.str();
+}
+
+// JSON string escaping into a new string (see appendJsonEscaped)
+std::string escapeJsonString(std::string_view input)
+{
+    std::string output;
+    output.reserve(input.length());
+    appendJsonEscaped(output, input);
+    return output;
+}
+
+// Value of the four hex digits at text[pos], or -1 if they are not all hex digits
+int parseHex4(std::string_view text, size_t pos)
+{
+    if (pos + 4 > text.size())
+    {
+        return -1;
+    }
+    int value = 0;
+    for (size_t i = pos; i < pos + 4; ++i)
+    {
+        char c = text[i];
+        int digit = (c >= '0' && c <= '9')   ? c - '0'
+                    : (c >= 'a' && c <= 'f') ? c - 'a' + 10
+                    : (c >= 'A' && c <= 'F') ? c - 'A' + 10
+                                             : -1;
+        if (digit < 0)
+        {
+            return -1;
+        }
+        value = value * 16 + digit;
+    }
+    return value;
+}
+
+// Appends a Unicode code point as UTF-8
+void appendUtf8(std::string &out, uint32_t codePoint)
+{
+    if (codePoint < 0x80)
+    {
+        out += static_cast<char>(codePoint);
+    }
+    else if (codePoint < 0x800)
+    {
+        out += static_cast<char>(0xC0 | (codePoint >> 6));
+        out += static_cast<char>(0x80 | (codePoint & 0x3F));
+    }
+    else if (codePoint < 0x10000)
+    {
+        out += static_cast<char>(0xE0 | (codePoint >> 12));
+        out += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (codePoint & 0x3F));
+    }
+    else
+    {
+        out += static_cast<char>(0xF0 | (codePoint >> 18));
+        out += static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F));
+        out += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (codePoint & 0x3F));
+    }
+}
+
+// Decodes the JSON string body `raw` into `out`, which must have room for raw.size() bytes
+// (decoding never grows a string). Returns the decoded length. \uXXXX escapes, including
+// surrogate pairs, become UTF-8; an unpaired surrogate becomes U+FFFD and unrecognized
+// escapes are kept as written.
+size_t decodeJsonStringInto(std::string_view raw, char *out)
+{
+    std::string utf8; // At most 4 bytes, so it stays in the small-string buffer
+    size_t length = 0;
+    size_t i = 0;
+    while (i < raw.size())
+    {
+        // Copy the run up to the next backslash in one go (memchr is vectorized)
+        size_t next = raw.find('\\', i);
+        size_t run = (next == std::string_view::npos ? raw.size() : next) - i;
+        std::memcpy(out + length, raw.data() + i, run);
+        length += run;
+        i += run;
+        if (i + 1 >= raw.size())
+        {
+            break; // No escape left, or a dangling backslash
+        }
+
+        char c = raw[i + 1];
+        i += 2;
+        char simple = 0;
+        switch (c)
+        {
+        case '"':
+        case '\\':
+        case '/':
+            simple = c;
+            break;
+        case 'n':
+            simple = '\n';
+            break;
+        case 'r':
+            simple = '\r';
+            break;
+        case 't':
+            simple = '\t';
+            break;
+        case 'b':
+            simple = '\b';
+            break;
+        case 'f':
+            simple = '\f';
+            break;
+        case 'u':
+        {
+            int unit = parseHex4(raw, i);
+            if (unit < 0)
+            {
+                break; // Not a valid escape, keep it as written
+            }
+            i += 4;
+            uint32_t codePoint = static_cast<uint32_t>(unit);
+            if (unit >= 0xD800 && unit <= 0xDBFF && i + 6 <= raw.size() && raw[i] == '\\' && raw[i + 1] == 'u')
+            {
+                int low = parseHex4(raw, i + 2);
+                if (low >= 0xDC00 && low <= 0xDFFF)
+                {
+                    codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + static_cast<uint32_t>(low - 0xDC00);
+                    i += 6;
+                }
+            }
+            if (codePoint >= 0xD800 && codePoint <= 0xDFFF)
+            {
+                codePoint = 0xFFFD; // Unpaired surrogate
+            }
+            utf8.clear();
+            appendUtf8(utf8, codePoint);
+            std::memcpy(out + length, utf8.data(), utf8.size());
+            length += utf8.size();
+            continue;
+        }
+        }
+
+        if (simple != 0)
+        {
+            out[length++] = simple;
+        }
+        else
+        {
+            out[length++] = '\\';
+            out[length++] = c;
+        }
+    }
+    return length;
+}
+
+// JSON string unescaping into a new string
+std::string unescapeJsonString(std::string_view input)
+{
+    std::string output(input.size(), '\0');
+    output.resize(decodeJsonStringInto(input, output.data()));
+    return output;
+}
+
+// Decodes a JSON string body for a task loaded into `arena`. Strings without escapes, i.e.
+// nearly all of them, are returned as is: `raw` already points into the file buffer held by
+// the arena. Only escaped strings are decoded, into new arena space.
+std::string_view decodeJsonString(std::string_view raw, StringArena &arena)
+{
+    if (raw.find('\\') == std::string_view::npos)
+    {
+        return raw;
+    }
+    char *out = arena.allocate(raw.size());
+    return {out, decodeJsonStringInto(raw, out)};
+}
+
+// Basic validation of a bare value: digits, optionally negative
+bool looksLikeInteger(std::string_view text)
+{
+    bool is_num = !text.empty();
+    for (size_t i = 0; i < text.length(); ++i)
+    {
+        if (i == 0 && text[i] == '-')
+            continue; // Allow leading minus
+        if (!std::isdigit(static_cast<unsigned char>(text[i])))
+        {
+            is_num = false;
+            break;
+        }
+    }
+    return is_num;
+}
+
+// Position of the quote that closes a JSON string whose opening quote is at `open`: the first
+// one not preceded by an odd number of backslashes. npos if the string is unterminated.
+size_t findClosingQuote(std::string_view text, size_t open)
+{
+    size_t close = open;
+    while ((close = text.find('"', close + 1)) != std::string_view::npos)
+    {
+        size_t backslashes = 0;
+        while (text[close - 1 - backslashes] == '\\')
+        {
+            backslashes++;
+        }
+        if (backslashes % 2 == 0)
+        {
+            return close;
+        }
+    }
+    return std::string_view::npos;
+}
+
+// Finds the value of `key` in a JSON object segment without copying: the body of a string
+// value (still escaped, see decodeJsonString) or the text of a number. Returns an empty view
+// if the key is missing or its value is malformed.
+std::string_view findJsonValue(std::string_view objectStr, std::string_view key)
+{
+    // Look for "key": without building the pattern
+    size_t keyPos = 0;
+    while (true)
+    {
+        keyPos = objectStr.find(key, keyPos);
+        if (keyPos == std::string_view::npos)
+        {
+            return {}; // Key not found
+        }
+        size_t after = keyPos + key.size();
+        if (keyPos > 0 && objectStr[keyPos - 1] == '"' && objectStr.substr(after, 2) == "\":")
+        {
+            break;
+        }
+        keyPos = after;
+    }
+
+    size_t valueStart = keyPos + key.size() + 2;
+
+    // Skip whitespace
+    while (valueStart < objectStr.length() && std::isspace(static_cast<unsigned char>(objectStr[valueStart])))
+    {
+        valueStart++;
+    }
+
+    if (valueStart >= objectStr.length())
+        return {}; // No value found
+
+    if (objectStr[valueStart] == '"')
+    { // String value
+        size_t valueEnd = findClosingQuote(objectStr, valueStart);
+        if (valueEnd != std::string_view::npos)
+        {
+            return objectStr.substr(valueStart + 1, valueEnd - valueStart - 1);
+        }
+        // If no closing quote is found, it's malformed
+        std::cerr << "Warning: Malformed JSON string value found for key '" << key << "'" << std::endl;
+        return {}; // Malformed string
+    }
+    else
+    { // Assume number (or potentially bool/null, but we only need numbers here)
+        // The value ends at the next comma or closing brace (or the end of the segment)
+        size_t valueEnd = std::min(objectStr.find_first_of(",}", valueStart), objectStr.length());
+        std::string_view numStr = objectStr.substr(valueStart, valueEnd - valueStart);
+
+        // Trim trailing whitespace from the extracted part
+        size_t lastChar = numStr.find_last_not_of(" \t\n\r\f\v");
+        if (lastChar == std::string_view::npos)
+        {
+            return {}; // Empty value
+        }
+        numStr = numStr.substr(0, lastChar + 1);
+
+        if (looksLikeInteger(numStr))
+        {
+            return numStr;
+        }
+        else
+        {
+            std::cerr << "Warning: Non-numeric value found for numeric key '" << key << "': " << numStr << std::endl;
+            return {};
+        }
+    }
+}
+
+// --- Timestamp Parsing ---
+
+// Half-open range of seconds [start, end) covered by a timestamp literal. A full
+// "YYYY-MM-DD HH:MM:SS" covers one second, a bare "YYYY-MM-DD" covers the whole day.
+struct TimeRange
+{
+    long long start;
+    long long end;
+};
+
+// Parses exactly `width` ASCII digits from text at pos
+bool parseDigits(std::string_view text, size_t pos, size_t width, int &value)
+{
+    if (pos + width > text.size())
+    {
+        return false;
+    }
+    value = 0;
+    for (size_t i = pos; i < pos + width; ++i)
+    {
+        if (text[i] < '0' || text[i] > '9')
+        {
+            return false;
+        }
+        value = value * 10 + (text[i] - '0');
+    }
+    return true;
+}
+
+// Parses "YYYY-MM-DD" or "YYYY-MM-DD HH:MM:SS" (the format written by getCurrentTimestamp).
+// Timestamps are compared as naive wall-clock values, so no time zone conversion is applied.
+std::optional<TimeRange> parseTimeRange(std::string_view text)
+{
+    int y, mo, d;
+    if (!parseDigits(text, 0, 4, y) || text.size() < 10 || text[4] != '-' || !parseDigits(text, 5, 2, mo) ||
+        text[7] != '-' || !parseDigits(text, 8, 2, d))
+    {
+        return std::nullopt;
+    }
+    std::chrono::year_month_day ymd{std::chrono::year{y}, std::chrono::month{static_cast<unsigned>(mo)},
+                                    std::chrono::day{static_cast<unsigned>(d)}};
+    if (!ymd.ok())
+    {
+        return std::nullopt;
+    }
+    long long dayStart = static_cast<long long>(std::chrono::sys_days{ymd}.time_since_epoch().count()) * 86400;
+    if (text.size() == 10)
+    {
+        return TimeRange{dayStart, dayStart + 86400};
+    }
+
+    int h, mi, s;
+    if (text.size() != 19 || (text[10] != ' ' && text[10] != 'T') || !parseDigits(text, 11, 2, h) ||
+        text[13] != ':' || !parseDigits(text, 14, 2, mi) || text[16] != ':' || !parseDigits(text, 17, 2, s) ||
+        h > 23 || mi > 59 || s > 60)
+    {
+        return std::nullopt;
+    }
+    long long second = dayStart + h * 3600 + mi * 60 + s;
+    return TimeRange{second, second + 1};
+}
+
+// --- Columnar Layout ---
+// A Task carries three string fields, so scanning the task vector for a status or a date
+// touches most of every element. TaskColumns keeps one array per field instead: a status
+// scan reads one byte per task, a date scan eight, and descriptions are laid out back to
+// back so substring search runs over a single buffer. Timestamps are stored pre-parsed.
+// A store loaded from the parsed-state cache gets its columns from there; otherwise they are
+// built from the tasks on first use.
+
+class TaskColumns;
+
+// Read-only view of one row, with the same getters as Task where the types allow
+class TaskRow
+{
+public:
+    TaskRow(const TaskColumns &columns, size_t index) : columns(&columns), index(index) {}
+
+    size_t getIndex() const { return index; } // Position in the store's task vector
+    int getID() const;
+    TaskStatus getStatusCode() const;
+    std::string_view getStatus() const { return statusName(getStatusCode()); }
+    std::string_view getDescription() const;
+    long long getCreatedTime() const; // Seconds since the epoch, TaskColumns::MISSING_TIME if unparsable
+    long long getUpdatedTime() const;
+
+private:
+    const TaskColumns *columns;
+    size_t index;
+};
+
+// Column groups built on top of ids and status (which are always there). A store builds
+// only the groups a command needs, so a status scan over a lazily loaded store never
+// decodes a description or a timestamp.
+enum ColumnGroup : uint8_t
+{
+    TIMESTAMP_COLUMNS = 1,
+    DESCRIPTION_COLUMNS = 2,
+    ALL_COLUMNS = TIMESTAMP_COLUMNS | DESCRIPTION_COLUMNS
+};
+
+class TaskColumns
+{
+public:
+    static constexpr long long MISSING_TIME = std::numeric_limits<long long>::min();
+
+    std::pmr::vector<int> ids;
+    std::pmr::vector<TaskStatus> status;
+    std::pmr::vector<long long> created;      // TIMESTAMP_COLUMNS
+    std::pmr::vector<long long> updated;      // TIMESTAMP_COLUMNS
+    std::string_view descriptions;            // DESCRIPTION_COLUMNS: description i is descriptions[offsets[i], offsets[i + 1])
+    std::pmr::vector<size_t> descriptionOffsets;
+
+    // Columns are allocated from the same memory resource as `tasks`
+    explicit TaskColumns(const TaskList &tasks, uint8_t groups = ALL_COLUMNS)
+        : ids(tasks.get_allocator()), status(tasks.get_allocator()), created(tasks.get_allocator()),
+          updated(tasks.get_allocator()), descriptionOffsets(tasks.get_allocator()), descriptionStorage(tasks.get_allocator())
+    {
+        PhaseTimer timer(Phase::IndexBuild);
+        ids.reserve(tasks.size());
+        status.reserve(tasks.size());
+        for (const auto &task : tasks)
+        {
+            ids.push_back(task.getID());
+            status.push_back(task.getStatusCode());
+        }
+        addGroups(tasks, groups);
+    }
+
+    // All columns, loaded from the cache; `descriptions` is not copied and must outlive them
+    TaskColumns(std::pmr::vector<int> ids, std::pmr::vector<TaskStatus> status, std::pmr::vector<long long> created,
+                std::pmr::vector<long long> updated, std::string_view descriptions, std::pmr::vector<size_t> descriptionOffsets)
+        : ids(std::move(ids)), status(std::move(status)), created(std::move(created)), updated(std::move(updated)),
+          descriptions(descriptions), descriptionOffsets(std::move(descriptionOffsets)),
+          descriptionStorage(this->ids.get_allocator()), built(ALL_COLUMNS)
+    {
+    }
+
+    bool hasGroups(uint8_t groups) const { return (built & groups) == groups; }
+
+    // Builds the requested groups that are missing; `tasks` must be the list the columns were built from
+    void addGroups(const TaskList &tasks, uint8_t groups)
+    {
+        PhaseTimer timer(Phase::IndexBuild);
+        groups &= ~built;
+        if (groups & TIMESTAMP_COLUMNS)
+        {
+            auto seconds = [](std::string_view timestamp)
+            {
+                auto range = parseTimeRange(timestamp);
+                return range ? range->start : MISSING_TIME;
+            };
+            created.reserve(tasks.size());
+            updated.reserve(tasks.size());
+            for (const auto &task : tasks)
+            {
+                created.push_back(seconds(task.getCreatedAt()));
+                updated.push_back(seconds(task.getUpdatedAt()));
+            }
+        }
+        if (groups & DESCRIPTION_COLUMNS)
+        {
+            size_t totalBytes = 0;
+            for (const auto &task : tasks)
+            {
+                totalBytes += task.getDescription().size();
+            }
+            descriptionStorage.reserve(totalBytes);
+            descriptionOffsets.reserve(tasks.size() + 1);
+            for (const auto &task : tasks)
+            {
+                descriptionOffsets.push_back(descriptionStorage.size());
+                std::string_view description = task.getDescription();
+                descriptionStorage.insert(descriptionStorage.end(), description.begin(), description.end());
+            }
+            descriptionOffsets.push_back(descriptionStorage.size());
+            descriptions = {descriptionStorage.data(), descriptionStorage.size()};
+        }
+        built |= groups;
+    }
+
+    size_t size() const { return ids.size(); }
+    TaskRow row(size_t index) const { return {*this, index}; }
+
+    std::string_view description(size_t index) const
+    {
+        return std::string_view(descriptions).substr(descriptionOffsets[index], descriptionOffsets[index + 1] - descriptionOffsets[index]);
+    }
+
+private:
+    // Backs `descriptions` when the columns were built here. A vector rather than a string:
+    // moving it keeps the buffer, so the view stays valid when the columns are moved.
+    std::pmr::vector<char> descriptionStorage;
+    uint8_t built = 0;
+};
+
+inline int TaskRow::getID() const { return columns->ids[index]; }
+inline TaskStatus TaskRow::getStatusCode() const { return columns->status[index]; }
+inline std::string_view TaskRow::getDescription() const { return columns->description(index); }
+inline long long TaskRow::getCreatedTime() const { return columns->created[index]; }
+inline long long TaskRow::getUpdatedTime() const { return columns->updated[index]; }
+
+// --- Timestamp Index ---
+
+enum class TimestampField
+{
+    CreatedAt,
+    UpdatedAt
+};
+
+std::string_view timestampOf(const Task &task, TimestampField field)
+{
+    return field == TimestampField::CreatedAt ? task.getCreatedAt() : task.getUpdatedAt();
+}
+
+// Sorted (timestamp, id) pairs for one timestamp field, so a range query is a binary search
+// plus a contiguous scan instead of parsing every timestamp string. Tasks whose timestamp
+// cannot be parsed are left out and therefore never match a range. Sorting costs more than
+// one scan, so the index is built when the cache is written and loaded with it (see
+// DerivedState); only a store without a current cache builds it on first use.
+class TimestampIndex
+{
+public:
+    struct Entry
+    {
+        long long timestamp;
+        int id;
+
+        auto operator<=>(const Entry &) const = default;
+    };
+
+    // `columns` must have TIMESTAMP_COLUMNS
+    TimestampIndex(const TaskColumns &columns, TimestampField field) : field(field), entries(columns.ids.get_allocator())
+    {
+        PhaseTimer timer(Phase::IndexBuild);
+        const auto &seconds = (field == TimestampField::CreatedAt) ? columns.created : columns.updated;
+        entries.reserve(columns.size());
+        for (size_t i = 0; i < columns.size(); ++i)
+        {
+            if (seconds[i] != TaskColumns::MISSING_TIME)
+            {
+                entries.push_back({seconds[i], columns.ids[i]});
+            }
+        }
+        std::ranges::sort(entries);
+    }
+
+    // An index saved earlier; `entries` must be sorted
+    TimestampIndex(TimestampField field, std::pmr::vector<Entry> entries) : field(field), entries(std::move(entries))
+    {
+    }
+
+    void insert(const Task &task)
+    {
+        if (auto range = parseTimeRange(timestampOf(task, field)))
+        {
+            Entry entry{range->start, task.getID()};
+            entries.insert(std::ranges::upper_bound(entries, entry), entry);
+        }
+    }
+
+    void erase(const Task &task)
+    {
+        if (auto range = parseTimeRange(timestampOf(task, field)))
+        {
+            auto it = std::ranges::lower_bound(entries, Entry{range->start, task.getID()});
+            if (it != entries.end() && it->timestamp == range->start && it->id == task.getID())
+            {
+                entries.erase(it);
+            }
+        }
+    }
+
+    size_t size() const { return entries.size(); }
+    std::span<const Entry> all() const { return entries; }
+
+    // Entries with lo <= timestamp < hi, in timestamp order
+    std::span<const Entry> range(long long lo, long long hi) const
+    {
+        auto first = std::ranges::lower_bound(entries, lo, {}, &Entry::timestamp);
+        auto last = std::ranges::lower_bound(first, entries.end(), hi, {}, &Entry::timestamp);
+        return {first, last};
+    }
+
+private:
+    TimestampField field;
+    std::pmr::vector<Entry> entries;
+};
+
+// --- Parsed-State Cache ---
+// Parsing dominates loading, yet most invocations read a file that has not changed since
+// the last one. Every load or save that produces the complete store therefore also writes
+// CACHE_FILE, a binary image of the parsed tasks stamped with the source's size, mtime,
+// inode and content hash. loadTasks() decodes the image instead of parsing when the stamp
+// still matches. The image uses the host's byte order and layout; any mismatch (including
+// a different build) just falls back to parsing.
+
+const std::string CACHE_FILE = TASKS_FILE + ".cache";
+bool parsedCacheEnabled = true; // Cleared by --no-cache
+
+// Fast non-cryptographic 64-bit hash, eight bytes per step. It only has to notice edits
+// the metadata checks miss (same size within one mtime tick), not adversarial collisions.
+uint64_t hashBytes(std::string_view data)
+{
+    auto mix = [](uint64_t x)
+    {
+        x ^= x >> 30;
+        x *= 0xBF58476D1CE4E5B9ULL;
+        x ^= x >> 27;
+        x *= 0x94D049BB133111EBULL;
+        return x ^ (x >> 31);
+    };
+    uint64_t hash = 0x9E3779B97F4A7C15ULL ^ data.size();
+    size_t i = 0;
+    for (; i + 8 <= data.size(); i += 8)
+    {
+        uint64_t word;
+        std::memcpy(&word, data.data() + i, 8);
+        hash = (hash ^ (word * 0xBF58476D1CE4E5B9ULL)) * 0x94D049BB133111EBULL;
+        hash ^= hash >> 32;
+    }
+    uint64_t tail = 0;
+    if (i < data.size())
+    {
+        std::memcpy(&tail, data.data() + i, data.size() - i);
+    }
+    return mix(hash ^ tail);
+}
+
+// Identifies one version of the source file
+struct SourceStamp
+{
+    uint64_t size = 0;
+    int64_t mtime = 0;
+    uint64_t inode = 0;
+    uint64_t hash = 0;
+
+    bool operator==(const SourceStamp &) const = default;
+};
+
+// Stamps `path` from its metadata alone: size, mtime and inode, with no content hash
+std::optional<SourceStamp> statFile(const std::string &path)
+{
+    std::error_code error;
+    auto mtime = std::filesystem::last_write_time(path, error);
+    uint64_t size = error ? 0 : std::filesystem::file_size(path, error);
+    if (error)
+    {
+        return std::nullopt;
+    }
+    SourceStamp stamp;
+    stamp.size = size;
+    stamp.mtime = static_cast<int64_t>(mtime.time_since_epoch().count());
+#ifndef _WIN32
+    struct stat info;
+    if (::stat(path.c_str(), &info) == 0)
+    {
+        stamp.inode = static_cast<uint64_t>(info.st_ino);
+    }
+#endif
+    return stamp;
+}
+
+// Stamps `path`, whose current contents are `content`
+std::optional<SourceStamp> stampFile(const std::string &path, std::string_view content)
+{
+    std::optional<SourceStamp> stamp = statFile(path);
+    if (stamp)
+    {
+        stamp->size = content.size();
+        stamp->hash = hashBytes(content);
+    }
+    return stamp;
+}
+
+// Structures derived from the tasks that the cache stores next to them. A load that hits
+// the cache hands them over (see TaskStore::load), so a one-shot command does not rebuild them.
+struct DerivedState
+{
+    std::optional<TaskColumns> columns;
+    std::optional<TimestampIndex> createdIndex;
+    std::optional<TimestampIndex> updatedIndex;
+};
+
+// On-disk layout: CacheHeader, taskCount CacheRecords, then textBytes of string data: all
+// descriptions back to back (descriptionBytes, which double as the description column),
+// followed by each task's createdAt and updatedAt. Then the entries of the createdAt and
+// updatedAt indexes, and the created and updated columns (taskCount seconds each).
+struct CacheHeader
+{
+    static constexpr uint64_t MAGIC = 0x3330484341435454ULL; // "TTCACH03" in little-endian
+
+    uint64_t magic;
+    SourceStamp source;
+    uint64_t taskCount;
+    uint64_t textBytes;
+    uint64_t descriptionBytes;
+    uint64_t createdEntries;
+    uint64_t updatedEntries;
+};
+
+struct CacheRecord
+{
+    int32_t id;
+    uint32_t status;
+    uint32_t descriptionLength;
+    uint32_t createdLength;
+    uint32_t updatedLength;
+};
+
+// Fills `tasks` and `derived` from the cache if it was written for `source`. Strings and
+// indexes are stored in `arena`.
+bool loadTaskCache(const SourceStamp &source, StringArena &arena, TaskList &tasks, DerivedState &derived)
+{
+    TraceSpan span("loadTaskCache");
+    std::ifstream file(CACHE_FILE, std::ios::binary);
+    CacheHeader header{};
+    if (!file.read(reinterpret_cast<char *>(&header), sizeof(header)) || header.magic != CacheHeader::MAGIC ||
+        header.source != source)
+    {
+        return false;
+    }
+    std::error_code error;
+    uint64_t expectedSize = sizeof(header) + header.taskCount * sizeof(CacheRecord) + header.textBytes +
+                            (header.createdEntries + header.updatedEntries) * sizeof(TimestampIndex::Entry) +
+                            header.taskCount * 2 * sizeof(long long);
+    if (std::filesystem::file_size(CACHE_FILE, error) != expectedSize || error || header.descriptionBytes > header.textBytes)
+    {
+        return false;
+    }
+
+    std::pmr::vector<CacheRecord> records(header.taskCount, arena.resource());
+    char *text = arena.allocate(header.textBytes);
+    std::pmr::vector<TimestampIndex::Entry> createdEntries(header.createdEntries, arena.resource());
+    std::pmr::vector<TimestampIndex::Entry> updatedEntries(header.updatedEntries, arena.resource());
+    std::pmr::vector<long long> created(header.taskCount, arena.resource());
+    std::pmr::vector<long long> updated(header.taskCount, arena.resource());
+    {
+        PhaseTimer timer(Phase::Read);
+        file.read(reinterpret_cast<char *>(records.data()), static_cast<std::streamsize>(records.size() * sizeof(CacheRecord)));
+        file.read(text, static_cast<std::streamsize>(header.textBytes));
+        file.read(reinterpret_cast<char *>(createdEntries.data()), static_cast<std::streamsize>(createdEntries.size() * sizeof(TimestampIndex::Entry)));
+        file.read(reinterpret_cast<char *>(updatedEntries.data()), static_cast<std::streamsize>(updatedEntries.size() * sizeof(TimestampIndex::Entry)));
+        file.read(reinterpret_cast<char *>(created.data()), static_cast<std::streamsize>(created.size() * sizeof(long long)));
+        file.read(reinterpret_cast<char *>(updated.data()), static_cast<std::streamsize>(updated.size() * sizeof(long long)));
+        if (!file)
+        {
+            return false;
+        }
+        commandStats.bytesRead += expectedSize;
+    }
+
+    tasks.clear();
+    tasks.reserve(records.size());
+    std::pmr::vector<int> ids(arena.resource());
+    std::pmr::vector<TaskStatus> status(arena.resource());
+    std::pmr::vector<size_t> descriptionOffsets(arena.resource());
+    ids.reserve(records.size());
+    status.reserve(records.size());
+    descriptionOffsets.reserve(records.size() + 1);
+    uint64_t descriptionOffset = 0;
+    uint64_t timeOffset = header.descriptionBytes;
+    for (const CacheRecord &record : records)
+    {
+        if (record.status >= std::size(STATUS_NAMES) || descriptionOffset + record.descriptionLength > header.descriptionBytes ||
+            timeOffset + record.createdLength + record.updatedLength > header.textBytes)
+        {
+            tasks.clear();
+            return false;
+        }
+        Task &task = tasks.emplace_back();
+        task.id = record.id;
+        task.status = static_cast<TaskStatus>(record.status);
+        task.description = TaskText::borrowed({text + descriptionOffset, record.descriptionLength});
+        task.createdAt = TaskText::borrowed({text + timeOffset, record.createdLength});
+        timeOffset += record.createdLength;
+        task.updatedAt = TaskText::borrowed({text + timeOffset, record.updatedLength});
+        timeOffset += record.updatedLength;
+        ids.push_back(task.id);
+        status.push_back(task.status);
+        descriptionOffsets.push_back(descriptionOffset);
+        descriptionOffset += record.descriptionLength;
+    }
+    descriptionOffsets.push_back(descriptionOffset);
+    derived.columns.emplace(std::move(ids), std::move(status), std::move(created), std::move(updated),
+                            std::string_view(text, header.descriptionBytes), std::move(descriptionOffsets));
+    derived.createdIndex.emplace(TimestampField::CreatedAt, std::move(createdEntries));
+    derived.updatedIndex.emplace(TimestampField::UpdatedAt, std::move(updatedEntries));
+    return true;
+}
+
+// Writes the cache for `tasks`, the parsed contents of the source stamped `source`, building
+// the parts of `derived` that are missing. Failure only costs the next load a parse, so it is
+// not reported.
+void writeTaskCache(const SourceStamp &source, const TaskList &tasks, DerivedState &derived)
+{
+    TraceSpan span("writeTaskCache");
+    if (!derived.columns)
+    {
+        derived.columns.emplace(tasks, TIMESTAMP_COLUMNS);
+    }
+    else
+    {
+        derived.columns->addGroups(tasks, TIMESTAMP_COLUMNS);
+    }
+    if (!derived.createdIndex)
+    {
+        derived.createdIndex.emplace(*derived.columns, TimestampField::CreatedAt);
+    }
+    if (!derived.updatedIndex)
+    {
+        derived.updatedIndex.emplace(*derived.columns, TimestampField::UpdatedAt);
+    }
+    std::string image;
+    {
+        PhaseTimer timer(Phase::Serialize);
+        std::span<const TimestampIndex::Entry> createdEntries = derived.createdIndex->all();
+        std::span<const TimestampIndex::Entry> updatedEntries = derived.updatedIndex->all();
+        std::span<const long long> created = derived.columns->created;
+        std::span<const long long> updated = derived.columns->updated;
+        CacheHeader header{CacheHeader::MAGIC, source, tasks.size(), 0, 0, createdEntries.size(), updatedEntries.size()};
+        std::vector<CacheRecord> records;
+        records.reserve(tasks.size());
+        for (const auto &task : tasks)
+        {
+            records.push_back({task.getID(), static_cast<uint32_t>(task.getStatusCode()),
+                               static_cast<uint32_t>(task.getDescription().size()),
+                               static_cast<uint32_t>(task.getCreatedAt().size()),
+                               static_cast<uint32_t>(task.getUpdatedAt().size())});
+            header.descriptionBytes += task.getDescription().size();
+            header.textBytes += task.getDescription().size() + task.getCreatedAt().size() + task.getUpdatedAt().size();
+        }
+        image.reserve(sizeof(header) + records.size() * sizeof(CacheRecord) + header.textBytes +
+                      createdEntries.size_bytes() + updatedEntries.size_bytes() + created.size_bytes() + updated.size_bytes());
+        image.append(reinterpret_cast<const char *>(&header), sizeof(header));
+        image.append(reinterpret_cast<const char *>(records.data()), records.size() * sizeof(CacheRecord));
+        for (const auto &task : tasks)
+        {
+            image += task.getDescription();
+        }
+        for (const auto &task : tasks)
+        {
+            image += task.getCreatedAt();
+            image += task.getUpdatedAt();
+        }
+        image.append(reinterpret_cast<const char *>(createdEntries.data()), createdEntries.size_bytes());
+        image.append(reinterpret_cast<const char *>(updatedEntries.data()), updatedEntries.size_bytes());
+        image.append(reinterpret_cast<const char *>(created.data()), created.size_bytes());
+        image.append(reinterpret_cast<const char *>(updated.data()), updated.size_bytes());
+    }
+
+    // Written under a temporary name and renamed, so a reader never sees a partial image
+    PhaseTimer timer(Phase::Write);
+    const std::string temporary = CACHE_FILE + ".tmp";
+    {
+        std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+        if (!file.write(image.data(), static_cast<std::streamsize>(image.size())))
+        {
+            return;
+        }
+    }
+    commandStats.bytesWritten += image.size();
+    std::error_code error;
+    std::filesystem::rename(temporary, CACHE_FILE, error);
+}
+
+// --- Store Metadata ---
+// Single-task commands should not have to parse the store. META_FILE holds what they need:
+// the store's format and highest id, and where each task object is in TASKS_FILE, all
+// stamped with the size, mtime and inode TASKS_FILE had after the last save, append or patch.
+// While the stamp matches, 'add' takes the next id from there and appends (see appendTask),
+// 'show' reads and parses just one object (see readTaskObject), and 'mark-*' rewrites a few
+// bytes of one (see patchTaskStatus). There is no content hash, since computing one would
+// read the whole file: an edit that keeps size, mtime and inode goes unnoticed. Deleting the
+// file is always safe.
+
+const std::string META_FILE = TASKS_FILE + ".meta";
+
+// On-disk layout: StoreMeta, then taskCount TaskOffsets sorted by id
+struct StoreMeta
+{
+    static constexpr uint64_t MAGIC = 0x32304154454D5454ULL; // "TTMETA02" in little-endian
+
+    uint64_t magic = MAGIC;
+    SourceStamp source; // Without a hash
+    int64_t maxId = 0;  // 0 for an empty store
+    uint64_t format = 0; // StoreFormat
+    uint64_t taskCount = 0;
+};
+
+// Bytes of one task object in TASKS_FILE, from '{' to '}'
+struct TaskOffset
+{
+    int32_t id;
+    uint32_t length;
+    uint64_t offset;
+};
+
+// The metadata of TASKS_FILE, if it was written for the file as it is now
+std::optional<StoreMeta> readStoreMeta()
+{
+    TraceSpan span("readStoreMeta");
+    std::ifstream file(META_FILE, std::ios::binary);
+    StoreMeta meta;
+    std::optional<SourceStamp> source = statFile(TASKS_FILE);
+    if (!source || !file.read(reinterpret_cast<char *>(&meta), sizeof(meta)) || meta.magic != StoreMeta::MAGIC ||
+        meta.source != *source || meta.format > static_cast<uint64_t>(StoreFormat::Ndjson))
+    {
+        return std::nullopt;
+    }
+    std::error_code error;
+    if (std::filesystem::file_size(META_FILE, error) != sizeof(meta) + meta.taskCount * sizeof(TaskOffset) || error)
+    {
+        return std::nullopt;
+    }
+    if (std::filesystem::exists(SHARD_MANIFEST, error))
+    {
+        return std::nullopt; // The store is sharded; a TASKS_FILE left next to it is not the store
+    }
+    commandStats.bytesRead += sizeof(meta);
+    return meta;
+}
+
+// Finds task `id` in the offsets described by `meta` with a binary search over the file, so
+// only about log2(taskCount) records are read
+std::optional<TaskOffset> findTaskOffset(const StoreMeta &meta, int id)
+{
+    TraceSpan span("findTaskOffset");
+    PhaseTimer timer(Phase::Read);
+    std::ifstream file(META_FILE, std::ios::binary);
+    uint64_t low = 0;
+    uint64_t high = meta.taskCount;
+    while (low < high)
+    {
+        uint64_t middle = low + (high - low) / 2;
+        TaskOffset record;
+        file.seekg(static_cast<std::streamoff>(sizeof(StoreMeta) + middle * sizeof(TaskOffset)));
+        if (!file.read(reinterpret_cast<char *>(&record), sizeof(record)))
+        {
+            return std::nullopt;
+        }
+        commandStats.bytesRead += sizeof(record);
+        if (record.id == id)
+        {
+            return record;
+        }
+        if (record.id < id)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+    return std::nullopt;
+}
+
+// Writes the metadata for TASKS_FILE as it is now: `format`, and the objects in `offsets`
+// (in any order). Like the cache, failure is not reported; commands just load the store.
+void writeStoreMeta(StoreFormat format, std::vector<TaskOffset> offsets)
+{
+    TraceSpan span("writeStoreMeta");
+    std::optional<SourceStamp> source = statFile(TASKS_FILE);
+    if (!source)
+    {
+        return;
+    }
+    std::ranges::sort(offsets, {}, &TaskOffset::id);
+    StoreMeta meta;
+    meta.source = *source;
+    meta.maxId = offsets.empty() ? 0 : offsets.back().id;
+    meta.format = static_cast<uint64_t>(format);
+    meta.taskCount = offsets.size();
+
+    // Written under a temporary name and renamed, so a reader never sees a partial table
+    PhaseTimer timer(Phase::Write);
+    const std::string temporary = META_FILE + ".tmp";
+    {
+        std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+        if (!file.write(reinterpret_cast<const char *>(&meta), sizeof(meta)) ||
+            !file.write(reinterpret_cast<const char *>(offsets.data()), static_cast<std::streamsize>(offsets.size() * sizeof(TaskOffset))))
+        {
+            return;
+        }
+    }
+    commandStats.bytesWritten += sizeof(meta) + offsets.size() * sizeof(TaskOffset);
+    std::error_code error;
+    std::filesystem::rename(temporary, META_FILE, error);
+}
+
+// Brings `meta` up to date after TASKS_FILE was changed in place: restamps it and records
+// `appended`, a new task with the highest id, if given. Only the header and the new record
+// are written, so the cost does not depend on the size of the store. A partial update
+// leaves a stamp or size that no longer matches, which readStoreMeta rejects.
+void updateStoreMeta(StoreMeta meta, const TaskOffset *appended = nullptr)
+{
+    TraceSpan span("updateStoreMeta");
+    std::optional<SourceStamp> source = statFile(TASKS_FILE);
+    if (!source)
+    {
+        return;
+    }
+    PhaseTimer timer(Phase::Write);
+    std::fstream file(META_FILE, std::ios::in | std::ios::out | std::ios::binary);
+    meta.source = *source;
+    if (appended != nullptr)
+    {
+        file.seekp(static_cast<std::streamoff>(sizeof(meta) + meta.taskCount * sizeof(TaskOffset)));
+        file.write(reinterpret_cast<const char *>(appended), sizeof(*appended));
+        meta.maxId = appended->id;
+        meta.taskCount++;
+        commandStats.bytesWritten += sizeof(*appended);
+    }
+    file.seekp(0);
+    file.write(reinterpret_cast<const char *>(&meta), sizeof(meta));
+    commandStats.bytesWritten += sizeof(meta);
+}
+
+// Parses a task id like std::stoi (and throws the same exceptions), without needing a std::string
+int parseTaskId(std::string_view text)
+{
+    int value = 0;
+    auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+    if (error == std::errc::result_out_of_range)
+    {
+        throw std::out_of_range(std::string(text));
+    }
+    if (error != std::errc() || end != text.data() + text.size())
+    {
+        throw std::invalid_argument(std::string(text));
+    }
+    return value;
+}
+
+// --- JSON Loading (using friend access) ---
+
+// Raw values of one task object, indexed like TASK_FIELDS; empty when missing
+using RawTaskFields = std::array<std::string_view, TASK_FIELD_COUNT>;
+
+// Generic path: one pass over the object's "key": value pairs in any order and spacing, each
+// key dispatched through findTaskField. Unknown keys are ignored and the first occurrence of
+// a repeated key wins.
+RawTaskFields scanTaskFields(std::string_view objectStr)
+{
+    RawTaskFields fields{};
+    size_t pos = 0;
+    while ((pos = objectStr.find('"', pos)) != std::string_view::npos)
+    {
+        size_t keyEnd = objectStr.find('"', pos + 1);
+        if (keyEnd == std::string_view::npos)
+        {
+            break;
+        }
+        std::string_view key = objectStr.substr(pos + 1, keyEnd - pos - 1);
+        size_t colon = objectStr.find_first_not_of(" \t\n\r\f\v", keyEnd + 1);
+        if (colon == std::string_view::npos || objectStr[colon] != ':')
+        {
+            pos = keyEnd + 1;
+            continue;
+        }
+        size_t valueStart = objectStr.find_first_not_of(" \t\n\r\f\v", colon + 1);
+        if (valueStart == std::string_view::npos)
+        {
+            break; // No value found
+        }
+
+        uint8_t field = findTaskField(key);
+        std::string_view value;
+        if (objectStr[valueStart] == '"')
+        {
+            size_t valueEnd = findClosingQuote(objectStr, valueStart);
+            if (valueEnd == std::string_view::npos)
+            {
+                std::cerr << "Warning: Malformed JSON string value found for key '" << key << "'" << std::endl;
+                break;
+            }
+            value = objectStr.substr(valueStart + 1, valueEnd - valueStart - 1);
+            pos = valueEnd + 1;
+        }
+        else
+        {
+            // A bare value ends at the next comma (or the end of the object)
+            size_t valueEnd = std::min(objectStr.find(',', valueStart), objectStr.length());
+            value = objectStr.substr(valueStart, valueEnd - valueStart);
+            value = value.substr(0, value.find_last_not_of(" \t\n\r\f\v") + 1);
+            pos = valueEnd;
+            if (field != NO_FIELD && !looksLikeInteger(value))
+            {
+                std::cerr << "Warning: Non-numeric value found for numeric key '" << key << "': " << value << std::endl;
+                continue;
+            }
+        }
+
+        if (field != NO_FIELD && fields[field].data() == nullptr)
+        {
+            fields[field] = value;
+        }
+    }
+    return fields;
+}
+
+// Fast path for objects exactly as saveTasks writes them in `layout`: the bytes between values
+// (the layout's prefixes) are compared with memcmp, and only the values themselves are scanned.
+// `pos` is just past the object's '{'. Returns the position of its closing '}', or npos when
+// the object deviates from that layout in any way (the caller then uses scanTaskFields).
+size_t matchCanonicalTask(std::string_view content, size_t pos, RawTaskFields &fields, const TaskLayout &layout = ARRAY_LAYOUT)
+{
+    auto literal = [&](std::string_view expected)
+    {
+        if (content.size() - pos < expected.size() || std::memcmp(content.data() + pos, expected.data(), expected.size()) != 0)
+        {
+            return false;
+        }
+        pos += expected.size();
+        return true;
+    };
+
+    for (size_t i = 0; i < TASK_FIELD_COUNT; ++i)
+    {
+        if (!literal(layout.prefixes[i].view()))
+        {
+            return std::string_view::npos;
+        }
+        size_t start = pos;
+        if (isQuoted(TASK_FIELDS[i].codec))
+        {
+            size_t quote = findClosingQuote(content, pos - 1);
+            if (quote == std::string_view::npos)
+            {
+                return std::string_view::npos;
+            }
+            fields[i] = content.substr(start, quote - start);
+            pos = quote + 1;
+            while (TASK_FIELDS[i].padTo != 0 && pos < content.size() && content[pos] == ' ')
+            {
+                pos++; // Padding (of any width, so files written before it was added still match)
+            }
+        }
+        else
+        {
+            pos += (pos < content.size() && content[pos] == '-');
+            size_t digits = pos;
+            while (pos < content.size() && content[pos] >= '0' && content[pos] <= '9')
+            {
+                pos++;
+            }
+            if (pos == digits)
+            {
+                return std::string_view::npos;
+            }
+            fields[i] = content.substr(start, pos - start);
+        }
+    }
+    return literal(layout.objectEnd) ? pos - 1 : std::string_view::npos;
+}
+
+// Validates the raw fields of one task object and fills `task` from them: decoded into
+// `arena`, or left as raw JSON text in a lazy load. Returns false, after printing why, if the
+// task has to be skipped.
+bool buildTask(const RawTaskFields &fields, StringArena &arena, bool lazy, Task &task)
+{
+    bool taskValid = true;
+    try
+    {
+        // Raw text in a lazy load, decoded text otherwise
+        auto text = [&](std::string_view raw)
+        {
+            return TaskText::borrowed(lazy ? raw : decodeJsonString(raw, arena));
+        };
+
+        // Basic validation of extracted values
+        for (size_t i = 0; i < TASK_FIELD_COUNT; ++i)
+        {
+            const TaskFieldDescriptor &field = TASK_FIELDS[i];
+            std::string_view raw = fields[i];
+            switch (field.codec)
+            {
+            case FieldCodec::Id:
+                if (raw.empty())
+                {
+                    std::cerr << "Warning: Skipping task due to missing or invalid ID." << std::endl;
+                    taskValid = false;
+                }
+                else
+                {
+                    task.id = parseTaskId(raw); // Use friend access
+                }
+                break;
+            case FieldCodec::Status:
+                if (std::optional<TaskStatus> parsedStatus = parseStatus(raw))
+                {
+                    task.status = *parsedStatus; // Use friend access
+                }
+                else
+                {
+                    std::cerr << "Warning: Skipping task ID " << task.id << " due to missing or invalid " << field.name << ": '" << raw << "'" << std::endl;
+                    taskValid = false;
+                }
+                break;
+            case FieldCodec::Text:
+                if (raw.empty())
+                {
+                    std::cerr << "Warning: Skipping task ID " << task.id << " due to missing " << field.name << "." << std::endl;
+                    taskValid = false;
+                }
+                else
+                {
+                    task.*field.text = text(raw); // Use friend access
+                    task.pendingFields |= lazy ? field.pendingFlag : 0;
+                }
+                break;
+            }
+        }
+    }
+    catch (const std::invalid_argument &e)
+    {
+        std::cerr << "Error parsing ID field as integer: " << e.what() << ". Skipping task fragment." << std::endl;
+        taskValid = false; // Ensure partially filled task isn't added
+    }
+    catch (const std::out_of_range &e)
+    {
+        std::cerr << "Error parsing ID field (out of range): " << e.what() << ". Skipping task fragment." << std::endl;
+        taskValid = false; // Ensure partially filled task isn't added
+    }
+    return taskValid;
+}
+
+// Parses a JSON array store into `tasks`. Returns false if anything was skipped.
+bool parseArrayTasks(std::string_view content, StringArena &arena, bool lazy, TaskList &tasks)
+{
+    // Trim leading/trailing whitespace just in case
+    content.remove_prefix(content.find_first_not_of(" \t\n\r\f\v"));
+    content = content.substr(0, content.find_last_not_of(" \t\n\r\f\v") + 1);
+
+    if (content.empty() || content == "[]")
+    {
+        return true; // Empty file or empty JSON array
+    }
+
+    // Very basic array parsing: find '[' and ']'
+    size_t startPos = content.find('[');
+    size_t endPos = content.rfind(']');
+    if (startPos == std::string::npos || endPos == std::string::npos || startPos >= endPos)
+    {
+        std::cerr << "Error: Invalid JSON format in " << TASKS_FILE << " (missing or misplaced array brackets)." << std::endl;
+        return false; // Return empty on major format error, and leave the cache alone
+    }
+
+    bool complete = true;
+    size_t currentPos = startPos + 1;
+    while (currentPos < endPos)
+    {
+        size_t objStart = content.find('{', currentPos);
+        if (objStart == std::string::npos || objStart >= endPos)
+            break; // No more objects
+
+        RawTaskFields fields;
+        size_t objEnd = matchCanonicalTask(content.substr(0, endPos), objStart + 1, fields);
+        if (objEnd == std::string_view::npos)
+        {
+            objEnd = content.find('}', objStart + 1);
+            // Basic brace balancing check (doesn't handle nested objects)
+            size_t nextObjStart = content.find('{', objStart + 1);
+            if (objEnd == std::string::npos || (nextObjStart != std::string::npos && objEnd > nextObjStart) || objEnd >= endPos)
+            {
+                std::cerr << "Error: Invalid JSON format in " << TASKS_FILE << " (mismatched or nested braces detected by simple check)." << std::endl;
+                // Attempt to recover might be complex, safer to stop parsing here
+                return false;
+            }
+            fields = scanTaskFields(content.substr(objStart + 1, objEnd - objStart - 1));
+        }
+
+        Task task; // Create default task object
+        if (buildTask(fields, arena, lazy, task))
+        {
+            tasks.push_back(std::move(task)); // Add valid task to vector
+        }
+        else
+        {
+            complete = false;
+        }
+
+        currentPos = objEnd + 1; // Move past the parsed object
+    }
+    return complete;
+}
+
+// Calls visit(valid, fields) for every non-blank line of `chunk`, with `valid` false for a
+// line that is not an object. Lines written by saveTasks are matched in place; only other
+// lines are delimited first and go through the generic scan.
+template <typename Visitor>
+void forEachNdjsonRecord(std::string_view chunk, Visitor &&visit)
+{
+    size_t pos = 0;
+    while ((pos = chunk.find_first_not_of(" \t\n\r\f\v", pos)) != std::string_view::npos)
+    {
+        RawTaskFields fields{};
+        if (chunk[pos] == '{')
+        {
+            size_t close = matchCanonicalTask(chunk, pos + 1, fields, NDJSON_LAYOUT);
+            size_t next = (close == std::string_view::npos) ? close : chunk.find_first_not_of(" \t\r\f\v", close + 1);
+            if (close != std::string_view::npos && (next == std::string_view::npos || chunk[next] == '\n'))
+            {
+                visit(true, fields);
+                pos = close + 1;
+                continue;
+            }
+        }
+        size_t lineEnd = std::min(chunk.find('\n', pos), chunk.size());
+        std::string_view line = chunk.substr(pos, lineEnd - pos);
+        size_t close = line.find_last_not_of(" \t\r\f\v");
+        bool valid = line[0] == '{' && close > 0 && line[close] == '}';
+        if (valid)
+        {
+            fields = scanTaskFields(line.substr(1, close - 1));
+        }
+        visit(valid, fields);
+        pos = lineEnd;
+    }
+}
+
+// Raw fields of one non-blank line; `valid` is false if the line is not an object
+struct NdjsonRecord
+{
+    RawTaskFields fields{};
+    bool valid = false;
+};
+
+constexpr size_t NDJSON_MIN_CHUNK_BYTES = 1 << 20; // Smaller stores are parsed on one thread
+
+// Parses an NDJSON store, read from `path`, into `tasks`. Returns false if anything was skipped.
+//
+// Locating the fields dominates parsing, so a large file is split at newlines into one chunk
+// per core and the chunks are scanned in parallel. The tasks are then built on this thread,
+// in file order: decoding allocates from the arena and the store's memory resource, neither
+// of which is thread-safe, and warnings come out in the order of the file.
+bool parseNdjsonTasks(std::string_view content, StringArena &arena, bool lazy, TaskList &tasks, const std::string &path = TASKS_FILE)
+{
+    bool complete = true;
+    auto addTask = [&](bool valid, const RawTaskFields &fields)
+    {
+        Task task;
+        if (!valid)
+        {
+            std::cerr << "Error: Invalid JSON format in " << path << " (a line is not a task object). Skipping it." << std::endl;
+            complete = false;
+        }
+        else if (buildTask(fields, arena, lazy, task))
+        {
+            tasks.push_back(std::move(task));
+        }
+        else
+        {
+            complete = false;
+        }
+    };
+
+    size_t threadCount = std::clamp<size_t>(content.size() / NDJSON_MIN_CHUNK_BYTES, 1,
+                                            std::max(1u, std::thread::hardware_concurrency()));
+    if (threadCount == 1)
+    {
+        forEachNdjsonRecord(content, addTask);
+        return complete;
+    }
+
+    std::vector<std::vector<NdjsonRecord>> chunks(threadCount);
+    std::vector<std::exception_ptr> errors(threadCount);
+    {
+        std::vector<std::jthread> workers; // Joined at the end of this block
+        size_t chunkStart = 0;
+        for (size_t i = 0; i < threadCount; ++i)
+        {
+            size_t chunkEnd = content.size();
+            if (i + 1 < threadCount)
+            {
+                size_t newline = content.find('\n', std::max(chunkStart, content.size() / threadCount * (i + 1)));
+                chunkEnd = (newline == std::string_view::npos) ? content.size() : newline + 1;
+            }
+            auto scan = [chunk = content.substr(chunkStart, chunkEnd - chunkStart), &records = chunks[i], &error = errors[i]]
+            {
+                TraceSpan span("scanNdjsonChunk");
+                try
+                {
+                    records.reserve(chunk.size() / 128);
+                    forEachNdjsonRecord(chunk, [&](bool valid, const RawTaskFields &fields)
+                                        { records.push_back({fields, valid}); });
+                }
+                catch (...)
+                {
+                    error = std::current_exception();
+                }
+            };
+            if (i + 1 < threadCount)
+            {
+                workers.emplace_back(scan);
+            }
+            else
+            {
+                scan(); // The last chunk is scanned on this thread
+            }
+            chunkStart = chunkEnd;
+        }
+    }
+    for (const std::exception_ptr &error : errors)
+    {
+        if (error)
+        {
+            std::rethrow_exception(error);
+        }
+    }
+
+    size_t recordCount = 0;
+    for (const auto &records : chunks)
+    {
+        recordCount += records.size();
+    }
+    tasks.reserve(recordCount);
+    for (const auto &records : chunks)
+    {
+        for (const NdjsonRecord &record : records)
+        {
+            addTask(record.valid, record.fields);
+        }
+    }
+    return complete;
+}
+
+// --- Sharded Store ---
+// A sharded store keeps its tasks in SHARD_DIR: one NDJSON file per range of `span` ids, and
+// SHARD_MANIFEST listing them. A save serializes every shard but only rewrites those whose
+// bytes changed, which it tells from the hash each shard had when it was last written, so
+// changing one task writes one shard however large the store is. A load reads the shards
+// in parallel and parses them as one NDJSON store. The manifest is written after the shards,
+// under a temporary name and renamed, so it never lists a shard that was not written.
+//
+// Manifest layout (text):
+//   task-cli-shards 1
+//   span <ids per shard>
+//   shard <first id> <task count> <hash>   (one line per shard, ascending by first id)
+
+constexpr int64_t SHARD_SPAN = 10000; // Ids per shard of a newly sharded store
+
+struct ShardEntry
+{
+    int64_t firstId;    // The shard holds ids firstId to firstId + span - 1
+    uint64_t taskCount;
+    uint64_t hash;      // hashBytes of the file as last written
+};
+
+struct ShardManifest
+{
+    int64_t span = SHARD_SPAN;
+    std::vector<ShardEntry> shards; // Ascending by firstId
+};
+
+// Shards in the manifest that the last load could not read. Their tasks are not in the store,
+// so a save keeps their entries and files as they are (see saveShardedTasks).
+std::vector<ShardEntry> unreadShards;
+
+std::string shardPath(int64_t firstId)
+{
+    return SHARD_DIR + "/" + std::to_string(firstId) + ".ndjson";
+}
+
+// First id of the shard that holds `id`
+int64_t shardFirstId(int64_t id, int64_t span)
+{
+    // Floor division, so that ids below 1 (only in a hand-edited store) get shards of their own
+    int64_t offset = id - 1;
+    int64_t index = (offset >= 0) ? offset / span : -((-offset + span - 1) / span);
+    return index * span + 1;
+}
+
+// The manifest of the sharded store, or nullopt if the store is not sharded. Throws if the
+// manifest exists but cannot be read, rather than treating the store as empty.
+std::optional<ShardManifest> readShardManifest()
+{
+    std::ifstream file(SHARD_MANIFEST);
+    if (!file.is_open())
+    {
+        return std::nullopt;
+    }
+    ShardManifest manifest;
+    std::string magic;
+    std::string key;
+    int version = 0;
+    if (!(file >> magic >> version >> key >> manifest.span) || magic != "task-cli-shards" || version != 1 ||
+        key != "span" || manifest.span <= 0)
+    {
+        throw std::runtime_error("Invalid shard manifest " + SHARD_MANIFEST);
+    }
+    ShardEntry entry;
+    while (file >> key >> entry.firstId >> entry.taskCount >> std::hex >> entry.hash >> std::dec)
+    {
+        if (key != "shard")
+        {
+            throw std::runtime_error("Invalid shard manifest " + SHARD_MANIFEST);
+        }
+        manifest.shards.push_back(entry);
+    }
+    if (!file.eof())
+    {
+        throw std::runtime_error("Invalid shard manifest " + SHARD_MANIFEST);
+    }
+    return manifest;
+}
+
+// Reads the shards listed in `manifest` into one buffer in `arena`, back to back with a
+// newline after each, and parses that as NDJSON. Returns false if anything was skipped.
+// Shards that cannot be read are recorded in unreadShards.
+//
+// The buffer is carved out of the arena up front, since the arena is not thread-safe, and
+// then each thread reads its share of the shards straight into its part of the buffer.
+// Parsing is split across threads by parseNdjsonTasks.
+bool loadShardedTasks(const ShardManifest &manifest, StringArena &arena, bool lazy, TaskList &tasks)
+{
+    TraceSpan span("loadShardedTasks");
+    std::string_view content;
+    bool complete = true;
+    {
+        PhaseTimer timer(Phase::Read);
+        std::vector<size_t> starts(manifest.shards.size() + 1); // Each shard's part of the buffer
+        for (size_t i = 0; i < manifest.shards.size(); ++i)
+        {
+            std::error_code error;
+            uint64_t size = std::filesystem::file_size(shardPath(manifest.shards[i].firstId), error);
+            starts[i + 1] = starts[i] + (error ? 0 : static_cast<size_t>(size)) + 1;
+        }
+        char *buffer = arena.allocate(starts.back());
+        std::vector<char> missing(manifest.shards.size());
+
+        auto readShard = [&](size_t i)
+        {
+            std::ifstream file(shardPath(manifest.shards[i].firstId), std::ios::binary);
+            size_t capacity = starts[i + 1] - starts[i] - 1;
+            file.read(buffer + starts[i], static_cast<std::streamsize>(capacity));
+            size_t bytes = static_cast<size_t>(file.gcount());
+            missing[i] = !file.is_open();
+            commandStats.bytesRead += bytes;
+            // A shard that shrank since it was sized leaves blank lines, which parse as nothing
+            std::memset(buffer + starts[i] + bytes, '\n', capacity - bytes + 1);
+        };
+
+        size_t threadCount = std::clamp<size_t>(starts.back() / NDJSON_MIN_CHUNK_BYTES, 1,
+                                                std::max<size_t>(1, std::min<size_t>(manifest.shards.size(), std::thread::hardware_concurrency())));
+        std::vector<std::jthread> workers; // Joined at the end of this block
+        for (size_t t = 1; t < threadCount; ++t)
+        {
+            workers.emplace_back([&, t]
+                                 {
+                TraceSpan span("readShards");
+                for (size_t i = t; i < manifest.shards.size(); i += threadCount)
+                {
+                    readShard(i);
+                } });
+        }
+        for (size_t i = 0; i < manifest.shards.size(); i += threadCount)
+        {
+            readShard(i); // Every threadCount-th shard is read on this thread
+        }
+        workers.clear();
+
+        for (size_t i = 0; i < manifest.shards.size(); ++i)
+        {
+            if (missing[i])
+            {
+                std::cerr << "Error: Could not read " << shardPath(manifest.shards[i].firstId) << ". Skipping its tasks." << std::endl;
+                unreadShards.push_back(manifest.shards[i]);
+                complete = false;
+            }
+        }
+        content = {buffer, starts.back()};
+    }
+
+    PhaseTimer timer(Phase::Parse);
+    size_t taskCount = 0;
+    for (const ShardEntry &shard : manifest.shards)
+    {
+        taskCount += shard.taskCount;
+    }
+    tasks.reserve(taskCount);
+    return parseNdjsonTasks(content, arena, lazy, tasks, SHARD_DIR) && complete;
+}
+
+// The file is read into `arena` and kept there: string fields without escapes point straight
+// into it, and only escaped ones are decoded into new arena space. The arena must outlive
+// the returned tasks, whose vector is allocated from the arena's memory resource.
+//
+// A lazy load (for read-only commands) only decodes id and status up front; description and
+// timestamps keep their raw JSON text and are decoded by the getters on first access. The
+// same tasks are skipped as in an eager load. A lazy load still writes the cache when it is
+// stale (say, after an 'add'), decoding every field for it, so that only the first read-only
+// command after a change parses the file.
+//
+// Sets storeFormat: a store with SHARD_MANIFEST is sharded (and TASKS_FILE is not read). A
+// file that starts with '{' is NDJSON, anything else a JSON array. A blank file is a JSON
+// array too, unless it is an empty NDJSON store as saveTasks left it (which the metadata
+// records), so only 'format' changes the format. A sharded store is never cached.
+TaskList loadTasks(StringArena &arena, bool lazy, DerivedState *derived)
+{
+    TraceSpan span("loadTasks");
+    TaskList tasks(arena.resource());
+    storeFormat = StoreFormat::JsonArray;
+    unreadShards.clear();
+    if (std::optional<ShardManifest> manifest = readShardManifest())
+    {
+        storeFormat = StoreFormat::Sharded;
+        loadShardedTasks(*manifest, arena, lazy, tasks);
+        return tasks;
+    }
+    std::string_view content;
+    {
+        PhaseTimer timer(Phase::Read);
+        std::ifstream file(TASKS_FILE, std::ios::binary);
+
+        if (!file.is_open())
+        {
+            // File doesn't exist is not an error, just means no tasks yet.
+            return tasks;
+        }
+
+        // Read the whole file in one call, sized up front
+        file.seekg(0, std::ios::end);
+        std::streamoff size = file.tellg();
+        file.seekg(0, std::ios::beg);
+        char *buffer = arena.allocate(size > 0 ? static_cast<size_t>(size) : 0);
+        file.read(buffer, size > 0 ? static_cast<std::streamsize>(size) : 0);
+        content = {buffer, static_cast<size_t>(file.gcount())};
+        commandStats.bytesRead += content.size();
+    }
+    PhaseTimer timer(Phase::Parse); // Also covers hashing and decoding the cache
+    size_t first = content.find_first_not_of(" \t\n\r\f\v");
+    if (first == std::string_view::npos)
+    {
+        std::optional<StoreMeta> meta = readStoreMeta();
+        if (meta && meta->format == static_cast<uint64_t>(StoreFormat::Ndjson))
+        {
+            storeFormat = StoreFormat::Ndjson;
+        }
+        return tasks; // Basic check for empty or just whitespace content
+    }
+    if (content[first] == '{')
+    {
+        storeFormat = StoreFormat::Ndjson;
+    }
+
+    DerivedState unused;
+    DerivedState &state = (derived != nullptr) ? *derived : unused;
+    std::optional<SourceStamp> stamp = parsedCacheEnabled ? stampFile(TASKS_FILE, content) : std::nullopt;
+    if (stamp && loadTaskCache(*stamp, arena, tasks, state))
+    {
+        return tasks;
+    }
+
+    // Only a store parsed without skipping anything is cached
+    bool complete = (storeFormat == StoreFormat::Ndjson) ? parseNdjsonTasks(content, arena, lazy, tasks)
+                                                         : parseArrayTasks(content, arena, lazy, tasks);
+    if (stamp && complete)
+    {
+        writeTaskCache(*stamp, tasks, state);
+    }
+    return tasks;
+}
+
+// --- JSON Saving (using getters) ---
+
+// Replaces the contents of path from `offset` on (by default, the whole file) with data and
+// flushes it to disk before returning. Without `truncate`, the bytes after data are kept.
+bool writeFileDurably(const std::string &path, std::string_view data, uint64_t offset = 0, bool truncate = true)
+{
+    TraceSpan span("writeFileDurably");
+#ifdef _WIN32
+    int fd = _open(path.c_str(), _O_WRONLY | _O_CREAT | (offset == 0 && truncate ? _O_TRUNC : 0) | _O_BINARY, _S_IREAD | _S_IWRITE);
+#else
+    int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | (offset == 0 && truncate ? O_TRUNC : 0), 0644);
+#endif
+    if (fd < 0)
+    {
+        std::cerr << "Error: Could not open " << path << " for writing." << std::endl;
+        return false;
+    }
+
+    bool ok = true;
+    {
+        PhaseTimer timer(Phase::Write);
+        if (offset != 0)
+        {
+#ifdef _WIN32
+            ok = _lseeki64(fd, static_cast<long long>(offset), SEEK_SET) >= 0 &&
+                 (!truncate || _chsize_s(fd, static_cast<long long>(offset + data.size())) == 0);
+#else
+            ok = ::lseek(fd, static_cast<off_t>(offset), SEEK_SET) >= 0 &&
+                 (!truncate || ::ftruncate(fd, static_cast<off_t>(offset + data.size())) == 0);
+#endif
+        }
+        size_t written = 0;
+        while (ok && written < data.size())
+        {
+            size_t chunk = std::min<size_t>(data.size() - written, 1 << 30);
+#ifdef _WIN32
+            auto n = _write(fd, data.data() + written, static_cast<unsigned>(chunk));
+#else
+            auto n = ::write(fd, data.data() + written, chunk);
+#endif
+            if (n <= 0)
+            {
+                ok = false;
+                break;
+            }
+            written += static_cast<size_t>(n);
+        }
+        commandStats.bytesWritten += written;
+    }
+    {
+        PhaseTimer timer(Phase::Fsync);
+#ifdef _WIN32
+        ok = (_commit(fd) == 0) && ok;
+        ok = (_close(fd) == 0) && ok;
+#else
+        ok = (::fsync(fd) == 0) && ok;
+        ok = (::close(fd) == 0) && ok;
+#endif
+    }
+    if (!ok)
+    { // Check if any write errors occurred
+        std::cerr << "Error: An error occurred while writing to " << path << "." << std::endl;
+    }
+    return ok;
+}
+
+// Appends one task object in `layout`
+void appendTaskObject(std::string &out, const Task &task, const TaskLayout &layout)
+{
+    out += '{';
+    // Use getter methods to access task data
+    for (size_t f = 0; f < TASK_FIELD_COUNT; ++f)
+    {
+        const TaskFieldDescriptor &field = TASK_FIELDS[f];
+        out += layout.prefixes[f].view();
+        switch (field.codec)
+        {
+        case FieldCodec::Id:
+            out += std::to_string(task.getID());
+            break;
+        case FieldCodec::Status:
+            out += task.getStatus(); // Status names never need escaping
+            break;
+        case FieldCodec::Text:
+            appendJsonEscaped(out, task.getText(field));
+            break;
+        }
+        if (isQuoted(field.codec))
+        {
+            out += '"';
+        }
+        if (field.codec == FieldCodec::Status)
+        {
+            out.append(field.padTo - task.getStatus().size(), ' ');
+        }
+    }
+    out += layout.objectEnd;
+}
+
+// Writes `manifest` as SHARD_MANIFEST, replacing the old one in a single rename
+bool writeShardManifest(const ShardManifest &manifest)
+{
+    std::string text = std::format("task-cli-shards 1\nspan {}\n", manifest.span);
+    for (const ShardEntry &shard : manifest.shards)
+    {
+        text += std::format("shard {} {} {:x}\n", shard.firstId, shard.taskCount, shard.hash);
+    }
+    const std::string temporary = SHARD_MANIFEST + ".tmp";
+    if (!writeFileDurably(temporary, text))
+    {
+        return false;
+    }
+    std::error_code error;
+    std::filesystem::rename(temporary, SHARD_MANIFEST, error);
+    if (error)
+    {
+        std::cerr << "Error: Could not replace " << SHARD_MANIFEST << ": " << error.message() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// saveTasks for a sharded store: rewrites the shards whose contents changed, then the
+// manifest, then removes the shards that no longer hold any task. The span of an existing
+// store is kept. Shards the load could not read stay in the manifest untouched; a task
+// that would go into one of them makes the save fail instead of overwriting it.
+void saveShardedTasks(const TaskList &tasks)
+{
+    TraceSpan span("saveShardedTasks");
+    std::optional<ShardManifest> previous = readShardManifest();
+    ShardManifest manifest;
+    manifest.span = previous ? previous->span : SHARD_SPAN;
+    auto shardOf = [&](size_t i)
+    {
+        return shardFirstId(tasks[i].getID(), manifest.span);
+    };
+
+    // Tasks grouped by shard, in store order within each shard
+    std::vector<size_t> order(tasks.size());
+    for (size_t i = 0; i < order.size(); ++i)
+    {
+        order[i] = i;
+    }
+    std::ranges::stable_sort(order, {}, shardOf);
+    for (const ShardEntry &unread : unreadShards)
+    {
+        if (std::ranges::binary_search(order, unread.firstId, {}, shardOf))
+        {
+            std::cerr << "Error: " << shardPath(unread.firstId) << " could not be read, and saving would overwrite it. "
+                      << "The store was not saved." << std::endl;
+            return;
+        }
+    }
+
+    std::error_code error;
+    std::filesystem::create_directories(SHARD_DIR, error);
+    if (error)
+    {
+        std::cerr << "Error: Could not create " << SHARD_DIR << ": " << error.message() << std::endl;
+        return;
+    }
+    std::string out;
+    for (size_t begin = 0, end = 0; begin < order.size(); begin = end)
+    {
+        ShardEntry shard{shardOf(order[begin]), 0, 0};
+        {
+            PhaseTimer timer(Phase::Serialize);
+            out.clear();
+            for (end = begin; end < order.size() && shardOf(order[end]) == shard.firstId; ++end)
+            {
+                appendTaskObject(out, tasks[order[end]], NDJSON_LAYOUT);
+                out += '\n';
+            }
+            shard.taskCount = end - begin;
+            shard.hash = hashBytes(out);
+        }
+        bool unchanged = false;
+        if (previous)
+        {
+            auto old = std::ranges::lower_bound(previous->shards, shard.firstId, {}, &ShardEntry::firstId);
+            unchanged = old != previous->shards.end() && old->firstId == shard.firstId && old->hash == shard.hash &&
+                        old->taskCount == shard.taskCount;
+        }
+        if (!unchanged && !writeFileDurably(shardPath(shard.firstId), out))
+        {
+            return; // The old manifest still describes the shards that were not written
+        }
+        manifest.shards.push_back(shard);
+    }
+    manifest.shards.insert(manifest.shards.end(), unreadShards.begin(), unreadShards.end());
+    std::ranges::sort(manifest.shards, {}, &ShardEntry::firstId);
+    if (!writeShardManifest(manifest))
+    {
+        return;
+    }
+
+    if (previous)
+    {
+        for (const ShardEntry &shard : previous->shards)
+        {
+            if (!std::ranges::binary_search(manifest.shards, shard.firstId, {}, &ShardEntry::firstId))
+            {
+                std::filesystem::remove(shardPath(shard.firstId), error);
+            }
+        }
+    }
+    // Left over from before the store was sharded
+    std::filesystem::remove(TASKS_FILE, error);
+    std::filesystem::remove(META_FILE, error);
+    std::filesystem::remove(CACHE_FILE, error);
+}
+
+void saveTasks(const TaskList &tasks, DerivedState *derived)
+{
+    TraceSpan span("saveTasks");
+    if (storeFormat == StoreFormat::Sharded)
+    {
+        saveShardedTasks(tasks);
+        return;
+    }
+    if (!unreadShards.empty())
+    {
+        // Converting would remove SHARD_DIR, and with it the shards that could not be read
+        std::cerr << "Error: " << shardPath(unreadShards.front().firstId) << " could not be read. "
+                  << "The store was not saved." << std::endl;
+        return;
+    }
+    // Serialize the whole store into one buffer, then write it with a single call
+    std::string out;
+    std::vector<TaskOffset> offsets(tasks.size()); // For the metadata
+    {
+        PhaseTimer timer(Phase::Serialize);
+        out.reserve(tasks.size() * 160 + 4);
+        auto append = [&](size_t i, const TaskLayout &layout)
+        {
+            size_t start = out.size();
+            appendTaskObject(out, tasks[i], layout);
+            offsets[i] = {tasks[i].getID(), static_cast<uint32_t>(out.size() - start), start};
+        };
+        if (storeFormat == StoreFormat::Ndjson)
+        {
+            for (size_t i = 0; i < tasks.size(); ++i)
+            {
+                append(i, NDJSON_LAYOUT);
+                out += '\n';
+            }
+        }
+        else
+        {
+            out += "[\n";
+            for (size_t i = 0; i < tasks.size(); ++i)
+            {
+                out += "  ";
+                append(i, ARRAY_LAYOUT);
+                // Comma between objects, none after the last one
+                out += (i < tasks.size() - 1) ? ",\n" : "\n";
+            }
+            out += "]\n";
+        }
+    }
+    if (!writeFileDurably(TASKS_FILE, out))
+    {
+        return;
+    }
+    std::error_code error;
+    std::filesystem::remove_all(SHARD_DIR, error); // Left over from a sharded store, which would take precedence
+    writeStoreMeta(storeFormat, std::move(offsets));
+    if (parsedCacheEnabled)
+    {
+        if (std::optional<SourceStamp> stamp = stampFile(TASKS_FILE, out))
+        {
+            DerivedState unused;
+            writeTaskCache(*stamp, tasks, (derived != nullptr) ? *derived : unused);
+        }
+    }
+}
+
+enum class AppendResult
+{
+    Appended,
+    Failed,     // The write failed and was reported
+    Unavailable // Nothing was written; the caller has to save the whole store
+};
+
+// Adds `task`, the one with the highest id, to the end of the store on disk without reading
+// or rewriting the rest: as one more line of NDJSON, or written over the closing ']' of a
+// JSON array. Either way the file ends up as saveTasks would have written it, provided it
+// was before. `meta` must be current (see readStoreMeta). Returns Unavailable, without
+// writing anything, if the file does not end the way saveTasks leaves it (the caller then
+// saves the whole store). If the write fails, the old end of the file is put back.
+//
+// The cache no longer matches the file afterwards; the next load or save rebuilds it.
+AppendResult appendTask(const Task &task, const StoreMeta &meta)
+{
+    StoreFormat format = static_cast<StoreFormat>(meta.format);
+    TraceSpan span("appendTask");
+    std::string tail; // The last bytes of the file, enough to see how it ends
+    uint64_t fileSize = 0;
+    {
+        PhaseTimer timer(Phase::Read);
+        std::ifstream file(TASKS_FILE, std::ios::binary | std::ios::ate);
+        if (!file.is_open())
+        {
+            return AppendResult::Unavailable;
+        }
+        fileSize = static_cast<uint64_t>(file.tellg());
+        tail.resize(std::min<uint64_t>(fileSize, 64));
+        file.seekg(static_cast<std::streamoff>(fileSize - tail.size()));
+        if (!file.read(tail.data(), static_cast<std::streamsize>(tail.size())))
+        {
+            return AppendResult::Unavailable;
+        }
+        commandStats.bytesRead += tail.size();
+    }
+
+    std::string record;
+    uint64_t offset = fileSize;
+    size_t objectStart = 0;
+    {
+        PhaseTimer timer(Phase::Serialize);
+        if (format == StoreFormat::Ndjson)
+        {
+            if (!tail.empty() && tail.back() != '\n')
+            {
+                record += '\n'; // A hand-edited file may lack the final newline
+            }
+            objectStart = record.size();
+            appendTaskObject(record, task, NDJSON_LAYOUT);
+            record += '\n';
+        }
+        else
+        {
+            // "...}\n]\n" or, for an empty store, "[\n]\n": the new object goes after the '}' or '['
+            size_t close = tail.find_last_not_of(" \t\n\r\f\v");
+            size_t last = (close == std::string::npos || close == 0) ? std::string::npos : tail.find_last_not_of(" \t\n\r\f\v", close - 1);
+            if (last == std::string::npos || tail[close] != ']' || (tail[last] != '}' && tail[last] != '['))
+            {
+                return AppendResult::Unavailable;
+            }
+            offset = fileSize - tail.size() + last + 1;
+            record += (tail[last] == '}') ? ",\n  " : "\n  ";
+            objectStart = record.size();
+            appendTaskObject(record, task, ARRAY_LAYOUT);
+            record += "\n]\n";
+        }
+    }
+    if (!writeFileDurably(TASKS_FILE, record, offset))
+    {
+        writeFileDurably(TASKS_FILE, std::string_view(tail).substr(offset - (fileSize - tail.size())), offset);
+        return AppendResult::Failed;
+    }
+    size_t objectLength = record.find_last_of('}') + 1 - objectStart;
+    TaskOffset appended{task.getID(), static_cast<uint32_t>(objectLength), offset + objectStart};
+    updateStoreMeta(meta, &appended);
+    return AppendResult::Appended;
+}
+
+enum class TaskLookup
+{
+    Found,
+    NotFound,   // The metadata is current and has no task with this id
+    Unavailable // The caller has to load the store
+};
+
+// Reads the object of task `id` on its own, from where META_FILE (described by `meta`) says it
+// is in TASKS_FILE, and matches it against the layout saveTasks writes, so that `fields` point
+// into `object`. An object that is not where the metadata says, or not in that layout, makes
+// the result Unavailable.
+TaskLookup readTaskObject(const StoreMeta &meta, int id, TaskOffset &location, std::string &object, RawTaskFields &fields)
+{
+    TraceSpan span("readTaskObject");
+    std::optional<TaskOffset> found = findTaskOffset(meta, id);
+    if (!found)
+    {
+        return TaskLookup::NotFound;
+    }
+    location = *found;
+
+    object.assign(location.length, '\0');
+    {
+        PhaseTimer timer(Phase::Read);
+        std::ifstream file(TASKS_FILE, std::ios::binary);
+        file.seekg(static_cast<std::streamoff>(location.offset));
+        if (!file.read(object.data(), static_cast<std::streamsize>(object.size())))
+        {
+            return TaskLookup::Unavailable;
+        }
+        commandStats.bytesRead += object.size();
+    }
+
+    PhaseTimer timer(Phase::Parse);
+    const TaskLayout &layout = (meta.format == static_cast<uint64_t>(StoreFormat::Ndjson)) ? NDJSON_LAYOUT : ARRAY_LAYOUT;
+    if (object.empty() || object.front() != '{' || matchCanonicalTask(object, 1, fields, layout) != object.size() - 1 ||
+        fields[ID_FIELD] != std::to_string(id))
+    {
+        return TaskLookup::Unavailable;
+    }
+    return TaskLookup::Found;
+}
+
+enum class PatchResult
+{
+    Patched,
+    NotFound,   // The metadata is current and has no task with this id
+    Failed,     // The write failed and was reported
+    Unavailable // Nothing was written; the caller has to save the whole store
+};
+
+// Sets the status and updatedAt of task `id` in TASKS_FILE by rewriting just those bytes, so
+// a status change costs the same for any store size. The object is found and read by
+// readTaskObject. Its status value is padded to STATUS_WIDTH, so any status fits in its
+// place, and updatedAt must keep its length, which holds for every timestamp written by
+// getCurrentTimestamp. If any of this does not apply (no current metadata, a file written
+// before status padding, a hand-edited timestamp), the result is Unavailable. If the write
+// fails, the old bytes are put back.
+//
+// Like appendTask, this leaves the cache stale.
+PatchResult patchTaskStatus(int id, TaskStatus status, std::string_view updatedAt)
+{
+    TraceSpan span("patchTaskStatus");
+    std::optional<StoreMeta> meta = readStoreMeta();
+    if (!meta)
+    {
+        return PatchResult::Unavailable;
+    }
+    TaskOffset location;
+    std::string object;
+    RawTaskFields fields;
+    switch (readTaskObject(*meta, id, location, object, fields))
+    {
+    case TaskLookup::Found:
+        break;
+    case TaskLookup::NotFound:
+        return PatchResult::NotFound;
+    case TaskLookup::Unavailable:
+        return PatchResult::Unavailable;
+    }
+
+    PhaseTimer timer(Phase::Serialize);
+    // The status slot runs from the value to the end of the padding after its closing quote
+    std::string_view name = statusName(status);
+    std::string updatedText = escapeJsonString(updatedAt);
+    size_t statusStart = static_cast<size_t>(fields[STATUS_FIELD].data() - object.data());
+    size_t slotEnd = object.find_first_not_of(' ', statusStart + fields[STATUS_FIELD].size() + 1);
+    size_t updatedStart = static_cast<size_t>(fields[UPDATED_AT_FIELD].data() - object.data());
+    if (name.size() + 1 > slotEnd - statusStart || updatedStart < slotEnd || fields[UPDATED_AT_FIELD].size() != updatedText.size())
+    {
+        return PatchResult::Unavailable;
+    }
+
+    // One write from the status to the end of updatedAt; the bytes between them are unchanged
+    std::string patch = object.substr(statusStart, updatedStart + updatedText.size() - statusStart);
+    patch.replace(0, slotEnd - statusStart, std::string(name) + '"' + std::string(slotEnd - statusStart - name.size() - 1, ' '));
+    patch.replace(updatedStart - statusStart, updatedText.size(), updatedText);
+    if (!writeFileDurably(TASKS_FILE, patch, location.offset + statusStart, false))
+    {
+        writeFileDurably(TASKS_FILE, std::string_view(object).substr(statusStart, patch.size()), location.offset + statusStart, false);
+        return PatchResult::Failed;
+    }
+    updateStoreMeta(*meta);
+    return PatchResult::Patched;
+}
+
+// --- Status Kernels ---
+// Counting tasks per status and selecting the tasks with one status both scan the status
+// column. Statuses are bytes, so SSE2/AVX2 compare 16/32 tasks per instruction. As with
+// substring search, the widest kernel the CPU supports is picked at runtime.
+
+using StatusCounts = std::array<size_t, 3>; // Indexed by TaskStatus
+
+// Counts each status in `status`
+using StatusCounter = StatusCounts (*)(std::span<const TaskStatus> status);
+
+// Sets bit i of `bitmap` (one uint64_t per 64 tasks, (size + 63) / 64 words) iff status[i] == wanted.
+// Returns the number of matches.
+using StatusSelector = size_t (*)(std::span<const TaskStatus> status, TaskStatus wanted, uint64_t *bitmap);
+
+StatusCounts countStatusesScalar(std::span<const TaskStatus> status)
+{
+    StatusCounts counts{};
+    for (TaskStatus value : status)
+    {
+        counts[static_cast<size_t>(value)]++;
+    }
+    return counts;
+}
+
+size_t selectStatusScalar(std::span<const TaskStatus> status, TaskStatus wanted, uint64_t *bitmap)
+{
+    size_t matches = 0;
+    for (size_t word = 0; word * 64 < status.size(); ++word)
+    {
+        size_t end = std::min(status.size(), word * 64 + 64);
+        uint64_t bits = 0;
+        for (size_t i = word * 64; i < end; ++i)
+        {
+            bits |= static_cast<uint64_t>(status[i] == wanted) << (i % 64);
+        }
+        bitmap[word] = bits;
+        matches += static_cast<size_t>(std::popcount(bits));
+    }
+    return matches;
+}
+
+#if TASK_CLI_X86_SIMD
+// Compare results are 0/-1 per byte, so subtracting them increments 8-bit lane counters.
+// Lanes are flushed into 64-bit totals (psadbw) before they can overflow. Every status is
+// one of three values, so done = total - todo - in-progress.
+StatusCounts countStatusesSse2(std::span<const TaskStatus> status)
+{
+    const auto *data = reinterpret_cast<const uint8_t *>(status.data());
+    const size_t size = status.size();
+    const __m128i todo = _mm_set1_epi8(static_cast<char>(TaskStatus::Todo));
+    const __m128i inProgress = _mm_set1_epi8(static_cast<char>(TaskStatus::InProgress));
+    const __m128i zero = _mm_setzero_si128();
+    __m128i todoTotal = zero;
+    __m128i inProgressTotal = zero;
+
+    size_t i = 0;
+    while (i + 16 <= size)
+    {
+        __m128i todoLanes = zero;
+        __m128i inProgressLanes = zero;
+        for (size_t round = 0; round < 255 && i + 16 <= size; ++round, i += 16)
+        {
+            const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+            todoLanes = _mm_sub_epi8(todoLanes, _mm_cmpeq_epi8(block, todo));
+            inProgressLanes = _mm_sub_epi8(inProgressLanes, _mm_cmpeq_epi8(block, inProgress));
+        }
+        todoTotal = _mm_add_epi64(todoTotal, _mm_sad_epu8(todoLanes, zero));
+        inProgressTotal = _mm_add_epi64(inProgressTotal, _mm_sad_epu8(inProgressLanes, zero));
+    }
+
+    uint64_t todoParts[2];
+    uint64_t inProgressParts[2];
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(todoParts), todoTotal);
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(inProgressParts), inProgressTotal);
+    StatusCounts counts = countStatusesScalar(status.subspan(i));
+    counts[0] += static_cast<size_t>(todoParts[0] + todoParts[1]);
+    counts[1] += static_cast<size_t>(inProgressParts[0] + inProgressParts[1]);
+    counts[2] = size - counts[0] - counts[1];
+    return counts;
+}
+
+size_t selectStatusSse2(std::span<const TaskStatus> status, TaskStatus wanted, uint64_t *bitmap)
+{
+    const auto *data = reinterpret_cast<const uint8_t *>(status.data());
+    const __m128i target = _mm_set1_epi8(static_cast<char>(wanted));
+    size_t matches = 0;
+    size_t word = 0;
+    for (; word * 64 + 64 <= status.size(); ++word)
+    {
+        uint64_t bits = 0;
+        for (size_t part = 0; part < 4; ++part)
+        {
+            const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + word * 64 + part * 16));
+            bits |= static_cast<uint64_t>(static_cast<uint16_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(block, target)))) << (part * 16);
+        }
+        bitmap[word] = bits;
+        matches += static_cast<size_t>(std::popcount(bits));
+    }
+    return matches + selectStatusScalar(status.subspan(word * 64), wanted, bitmap + word);
+}
+
+__attribute__((target("avx2"))) StatusCounts countStatusesAvx2(std::span<const TaskStatus> status)
+{
+    const auto *data = reinterpret_cast<const uint8_t *>(status.data());
+    const size_t size = status.size();
+    const __m256i todo = _mm256_set1_epi8(static_cast<char>(TaskStatus::Todo));
+    const __m256i inProgress = _mm256_set1_epi8(static_cast<char>(TaskStatus::InProgress));
+    const __m256i zero = _mm256_setzero_si256();
+    __m256i todoTotal = zero;
+    __m256i inProgressTotal = zero;
+
+    size_t i = 0;
+    while (i + 32 <= size)
+    {
+        __m256i todoLanes = zero;
+        __m256i inProgressLanes = zero;
+        for (size_t round = 0; round < 255 && i + 32 <= size; ++round, i += 32)
+        {
+            const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i));
+            todoLanes = _mm256_sub_epi8(todoLanes, _mm256_cmpeq_epi8(block, todo));
+            inProgressLanes = _mm256_sub_epi8(inProgressLanes, _mm256_cmpeq_epi8(block, inProgress));
+        }
+        todoTotal = _mm256_add_epi64(todoTotal, _mm256_sad_epu8(todoLanes, zero));
+        inProgressTotal = _mm256_add_epi64(inProgressTotal, _mm256_sad_epu8(inProgressLanes, zero));
+    }
+
+    alignas(32) uint64_t todoParts[4];
+    alignas(32) uint64_t inProgressParts[4];
+    _mm256_store_si256(reinterpret_cast<__m256i *>(todoParts), todoTotal);
+    _mm256_store_si256(reinterpret_cast<__m256i *>(inProgressParts), inProgressTotal);
+    // g++ 12 at -O2 emits no vzeroupper before this call (checked with objdump -d), and SSE
+    // code that runs with the upper YMM halves still dirty is slow on many CPUs
+    _mm256_zeroupper();
+    StatusCounts counts = countStatusesSse2(status.subspan(i));
+    counts[0] += static_cast<size_t>(todoParts[0] + todoParts[1] + todoParts[2] + todoParts[3]);
+    counts[1] += static_cast<size_t>(inProgressParts[0] + inProgressParts[1] + inProgressParts[2] + inProgressParts[3]);
+    counts[2] = size - counts[0] - counts[1];
+    return counts;
+}
+
+__attribute__((target("avx2"))) size_t selectStatusAvx2(std::span<const TaskStatus> status, TaskStatus wanted, uint64_t *bitmap)
+{
+    const auto *data = reinterpret_cast<const uint8_t *>(status.data());
+    const __m256i target = _mm256_set1_epi8(static_cast<char>(wanted));
+    size_t matches = 0;
+    size_t word = 0;
+    for (; word * 64 + 64 <= status.size(); ++word)
+    {
+        const __m256i low = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + word * 64));
+        const __m256i high = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + word * 64 + 32));
+        uint64_t bits = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(low, target))) |
+                        static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(high, target)))) << 32;
+        bitmap[word] = bits;
+        matches += static_cast<size_t>(std::popcount(bits));
+    }
+    return matches + selectStatusScalar(status.subspan(word * 64), wanted, bitmap + word);
+}
+#endif
+
+struct StatusKernels
+{
+    StatusCounter count;
+    StatusSelector select;
+};
+
+// Picks the widest kernels the running CPU supports (checked once per process)
+StatusKernels selectStatusKernels()
+{
+#if TASK_CLI_X86_SIMD
+    static const StatusKernels kernels = __builtin_cpu_supports("avx2") ? StatusKernels{countStatusesAvx2, selectStatusAvx2}
+                                                                        : StatusKernels{countStatusesSse2, selectStatusSse2};
+    return kernels;
+#else
+    return {countStatusesScalar, selectStatusScalar};
+#endif
+}
+
+// --- Task Store ---
+
+// The loaded tasks plus secondary indexes. Indexes come from the parsed-state cache or are
+// built on first use and, once there, kept in sync by the mutation functions via
+// beforeChange()/afterChange(). The columns also come from the cache or are built on first
+// use, but are simply dropped on any change and rebuilt by the next scan.
+struct TaskStore
+{
+    StringArena arena; // Declared first so it outlives the tasks whose strings point into it
+    TaskList tasks;
+    DerivedState derived; // The columnar copy and the timestamp indexes
+    std::optional<bool> idsAscending; // Lets find() binary search; add/delete preserve the order
+    bool unloaded = false;            // Set by main() for 'add', 'mark-*' and 'show', which load only if they have to
+
+    // Everything the store allocates (tasks, strings, indexes) comes from `resource`
+    explicit TaskStore(std::pmr::memory_resource *resource = std::pmr::get_default_resource())
+        : arena(resource), tasks(resource)
+    {
+    }
+
+    void load(bool lazy = false)
+    {
+        tasks = loadTasks(arena, lazy, &derived);
+        unloaded = false;
+    }
+
+    // Saves the tasks and caches the indexes with them
+    void save() { saveTasks(tasks, &derived); }
+
+    // Swaps in a whole new task list, dropping everything derived from the old one
+    void replaceAll(TaskList replacement)
+    {
+        tasks = std::move(replacement);
+        derived = {};
+        idsAscending.reset();
+    }
+
+    Task *find(int id)
+    {
+        if (!idsAscending)
+        {
+            idsAscending = std::ranges::is_sorted(tasks, {}, &Task::getID);
+        }
+        auto it = *idsAscending ? std::ranges::lower_bound(tasks, id, {}, &Task::getID)
+                                : std::ranges::find(tasks, id, &Task::getID);
+        return (it != tasks.end() && it->getID() == id) ? &*it : nullptr;
+    }
+
+    const TimestampIndex &timestampIndex(TimestampField field)
+    {
+        auto &index = (field == TimestampField::CreatedAt) ? derived.createdIndex : derived.updatedIndex;
+        if (!index)
+        {
+            index.emplace(columns(TIMESTAMP_COLUMNS), field);
+        }
+        return *index;
+    }
+
+    // Ids and status plus the requested column groups
+    const TaskColumns &columns(uint8_t groups = 0)
+    {
+        if (!derived.columns)
+        {
+            derived.columns.emplace(tasks, groups);
+        }
+        else if (!derived.columns->hasGroups(groups))
+        {
+            derived.columns->addGroups(tasks, groups);
+        }
+        return *derived.columns;
+    }
+
+    // Row of a task in the columnar copy; `task` must point into `tasks`
+    TaskRow rowOf(const Task &task, uint8_t groups)
+    {
+        return columns(groups).row(static_cast<size_t>(&task - tasks.data()));
+    }
+
+    // Call before modifying or removing a task that is already in the store
+    void beforeChange(const Task &task)
+    {
+        derived.columns.reset();
+        if (derived.createdIndex)
+        {
+            derived.createdIndex->erase(task);
+        }
+        if (derived.updatedIndex)
+        {
+            derived.updatedIndex->erase(task);
+        }
+    }
+
+    // Call after modifying or adding a task
+    void afterChange(const Task &task)
+    {
+        derived.columns.reset();
+        if (derived.createdIndex)
+        {
+            derived.createdIndex->insert(task);
+        }
+        if (derived.updatedIndex)
+        {
+            derived.updatedIndex->insert(task);
+        }
+    }
+};
+
+// --- Task Management Logic (using Task class methods and C++20 features) ---
+// The id after `maxId`, the highest id in the store
+int nextIdAfter(int64_t maxId)
+{
+    if (maxId >= std::numeric_limits<int>::max())
+    {
+        throw std::overflow_error("Cannot generate new task ID, maximum integer value reached.");
+    }
+    return static_cast<int>(maxId) + 1;
+}
+
+int getNextId(const TaskList &tasks)
+{
+    if (tasks.empty())
+    {
+        return 1;
+    }
+    auto max_it = std::ranges::max_element(tasks, {}, &Task::getID);
+    // It's guaranteed to find an element if tasks is not empty
+    int maxId = max_it->getID(); // Dereference iterator to get Task, then get ID
+    return nextIdAfter(maxId);
+}
+
+void addTask(TaskStore &store, const std::string &description)
+{
+    if (description.empty())
+    {
+        std::cerr << "Error: Task description cannot be empty." << std::endl;
+        return;
+    }
+    try
+    {
+        // main() leaves the store unloaded for 'add'. While the metadata matches the file, the
+        // id comes from there and the store is never read; otherwise it is loaded now.
+        std::optional<StoreMeta> meta = readStoreMeta();
+        if (store.unloaded)
+        {
+            if (meta)
+            {
+                Task newTask(nextIdAfter(meta->maxId), description);
+                switch (appendTask(newTask, *meta))
+                {
+                case AppendResult::Appended:
+                    std::cout << "Task added successfully (ID: " << newTask.getID() << ")" << std::endl;
+                    return;
+                case AppendResult::Failed:
+                    return;
+                case AppendResult::Unavailable:
+                    break;
+                }
+                meta.reset();
+            }
+            store.load();
+        }
+
+        int newId = getNextId(store.tasks);
+        // Use the Task constructor that sets timestamps etc.
+        Task newTask(newId, description);
+        store.tasks.push_back(newTask);
+        store.afterChange(newTask);
+        // Without current metadata the whole store is saved, which rewrites the metadata
+        AppendResult appended = meta ? appendTask(newTask, *meta) : AppendResult::Unavailable;
+        if (appended == AppendResult::Failed)
+        {
+            return;
+        }
+        if (appended == AppendResult::Unavailable)
+        {
+            store.save();
+        }
+        std::cout << "Task added successfully (ID: " << newId << ")" << std::endl;
+    }
+    catch (const std::overflow_error &e)
+    {
+        std::cerr << "Error adding task: " << e.what() << std::endl;
+    }
+}
+
+void updateTask(TaskStore &store, int id, const std::string &newDescription)
+{
+    if (newDescription.empty())
+    {
+        std::cerr << "Error: New task description cannot be empty." << std::endl;
+        return;
+    }
+    Task *task = store.find(id);
+
+    if (task != nullptr)
+    {
+        store.beforeChange(*task);
+        task->setDescription(newDescription); // Setter updates timestamp
+        store.afterChange(*task);
+        store.save();
+        std::cout << "Task " << id << " updated successfully." << std::endl;
+    }
+    else
+    {
+        std::cerr << "Error: Task with ID " << id << " not found for update." << std::endl;
+    }
+}
+
+void deleteTask(TaskStore &store, int id)
+{
+    size_t numRemoved = std::erase_if(store.tasks, [&store, id](const Task &task)
+                                      {
+                                          if (task.getID() != id) // Use getter in lambda
+                                          {
+                                              return false;
+                                          }
+                                          store.beforeChange(task);
+                                          return true; });
+
+    if (numRemoved > 0)
+    { // Check if any elements were actually removed
+        store.save();
+        std::cout << "Task " << id << " deleted successfully." << std::endl;
+    }
+    else
+    {
+        std::cerr << "Error: Task with ID " << id << " not found for deletion." << std::endl;
+    }
+}
+
+void markTaskStatus(TaskStore &store, int id, const std::string &status)
+{
+    // Basic validation of the status string remains useful
+    if (status != "todo" && status != "in-progress" && status != "done")
+    {
+        std::cerr << "Error: Invalid status '" << status << "'. Use 'todo', 'in-progress', or 'done'." << std::endl;
+        return;
+    }
+    // main() leaves the store unloaded for 'mark-*'. With current metadata only the task's own
+    // object is read and patched; otherwise the store is loaded now.
+    if (store.unloaded)
+    {
+        switch (patchTaskStatus(id, *parseStatus(status), getCurrentTimestamp()))
+        {
+        case PatchResult::Patched:
+            std::cout << "Task " << id << " status updated." << std::endl;
+            return;
+        case PatchResult::NotFound:
+            std::cerr << "Error: Task with ID " << id << " not found to mark status." << std::endl;
+            return;
+        case PatchResult::Failed:
+            return;
+        case PatchResult::Unavailable:
+            store.load();
+            break;
+        }
+    }
+    Task *task = store.find(id);
+
+    if (task != nullptr)
+    { // Check if found
+        store.beforeChange(*task);
+        task->setStatus(status); // Setter validates & handles timestamp
+        store.afterChange(*task);
+        PatchResult patched = patchTaskStatus(id, task->getStatusCode(), task->getUpdatedAt());
+        if (patched == PatchResult::Failed)
+        {
+            return;
+        }
+        if (patched != PatchResult::Patched)
+        {
+            store.save();
+        }
+        // The setStatus method now prints warnings, so a simple notification is sufficient
+        std::cout << "Task " << id << " status updated." << std::endl; // Message adjusted slightly
+    }
+    else
+    {
+        std::cerr << "Error: Task with ID " << id << " not found to mark status." << std::endl;
+    }
+}
+
+// Prints a single task in the block format shared by 'list' and 'search'
+void printTask(const Task &task)
+{
+    // Use getters for display - using std::format for cleaner output
+    std::cout << std::format(
+        "ID: {}\n"
+        "  Description: {}\n"
+        "  Status: {}\n"
+        "  Created: {}\n"
+        "  Updated: {}\n"
+        "-------------\n",
+        task.getID(),
+        task.getDescription(),
+        task.getStatus(),
+        task.getCreatedAt(),
+        task.getUpdatedAt());
+}
+
+void showTask(TaskStore &store, int id)
+{
+    // main() leaves the store unloaded for 'show'. With current metadata only the task's own
+    // object is read and parsed; otherwise the store is loaded now.
+    if (store.unloaded)
+    {
+        std::optional<StoreMeta> meta = readStoreMeta();
+        TaskOffset location;
+        std::string object;
+        RawTaskFields fields;
+        switch (meta ? readTaskObject(*meta, id, location, object, fields) : TaskLookup::Unavailable)
+        {
+        case TaskLookup::Found:
+        {
+            Task task;
+            if (buildTask(fields, store.arena, false, task))
+            {
+                printTask(task);
+                return;
+            }
+            break;
+        }
+        case TaskLookup::NotFound:
+            std::cerr << "Error: Task with ID " << id << " not found." << std::endl;
+            return;
+        case TaskLookup::Unavailable:
+            break;
+        }
+        store.load();
+    }
+    const Task *task = store.find(id);
+
+    if (task != nullptr)
+    {
+        printTask(*task);
+    }
+    else
+    {
+        std::cerr << "Error: Task with ID " << id << " not found." << std::endl;
+    }
+}
+
+void listTasks(TaskStore &store, const std::string &filter = "all")
+{
+    TraceSpan span("listTasks");
+    std::cout << "\n--- Tasks";
+    if (filter != "all")
+    {
+        std::cout << " (Status: " << filter << ")";
+    }
+    std::cout << " ---" << std::endl;
+
+    bool tasksDisplayed = false;
+    if (std::optional<TaskStatus> wanted = parseStatus(filter))
+    {
+        // Select matching rows from the status column first, then visit only the set bits
+        std::span<const TaskStatus> status = store.columns().status;
+        std::vector<uint64_t> bitmap((status.size() + 63) / 64);
+        tasksDisplayed = selectStatusKernels().select(status, *wanted, bitmap.data()) > 0;
+        for (size_t word = 0; word < bitmap.size(); ++word)
+        {
+            for (uint64_t bits = bitmap[word]; bits != 0; bits &= bits - 1)
+            {
+                printTask(store.tasks[word * 64 + static_cast<size_t>(std::countr_zero(bits))]);
+            }
+        }
+    }
+    else
+    {
+        for (const auto &task : store.tasks)
+        {
+            tasksDisplayed = true;
+            printTask(task);
+        }
+    }
+
+    if (!tasksDisplayed)
+    {
+        if (filter == "all")
+        {
+            std::cout << "No tasks found." << std::endl;
+        }
+        else
+        {
+            std::cout << "No tasks found with status '" << filter << "'." << std::endl;
+        }
+        std::cout << "-------------" << std::endl;
+    }
+}
+
+// --- Substring Search (unindexed scan) ---
+// There is no persistent search index, so 'search' scans every description. Instead of
+// calling std::string::find once per task, it scans the contiguous description column in a
+// single pass with a SIMD first-byte/last-byte filter.
+
+// Returns the first position >= from at which needle occurs in haystack, or std::string_view::npos.
+using SubstringScanner = size_t (*)(std::string_view haystack, std::string_view needle, size_t from);
+
+size_t findSubstringScalar(std::string_view haystack, std::string_view needle, size_t from)
+{
+    return haystack.find(needle, from);
+}
+
+#if TASK_CLI_X86_SIMD
+// Compares the first and last byte of the needle against 16 candidate start positions at once
+// and only runs memcmp on positions where both match (W. Mula's "generic SIMD" strstr).
+size_t findSubstringSse2(std::string_view haystack, std::string_view needle, size_t from)
+{
+    const size_t k = needle.size();
+    if (k < 2 || haystack.size() < k)
+    {
+        return haystack.find(needle, from); // memchr is already vectorized for one byte
+    }
+    const char *data = haystack.data();
+    const size_t lastStart = haystack.size() - k;
+    const __m128i first = _mm_set1_epi8(needle.front());
+    const __m128i last = _mm_set1_epi8(needle.back());
+
+    size_t i = from;
+    for (; i + 16 <= lastStart + 1; i += 16)
+    {
+        const __m128i blockFirst = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+        const __m128i blockLast = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i + k - 1));
+        unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(
+            _mm_and_si128(_mm_cmpeq_epi8(first, blockFirst), _mm_cmpeq_epi8(last, blockLast))));
+        while (mask != 0)
+        {
+            const size_t pos = i + std::countr_zero(mask);
+            if (std::memcmp(data + pos + 1, needle.data() + 1, k - 2) == 0)
+            {
+                return pos;
+            }
+            mask &= mask - 1;
+        }
+    }
+    return haystack.find(needle, i); // Fewer than 16 start positions left
+}
+
+// Same filter as the SSE2 version over 32 start positions per iteration
+__attribute__((target("avx2"))) size_t findSubstringAvx2(std::string_view haystack, std::string_view needle, size_t from)
+{
+    const size_t k = needle.size();
+    if (k < 2 || haystack.size() < k)
+    {
+        return haystack.find(needle, from);
+    }
+    const char *data = haystack.data();
+    const size_t lastStart = haystack.size() - k;
+    const __m256i first = _mm256_set1_epi8(needle.front());
+    const __m256i last = _mm256_set1_epi8(needle.back());
+
+    size_t i = from;
+    for (; i + 32 <= lastStart + 1; i += 32)
+    {
+        const __m256i blockFirst = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i));
+        const __m256i blockLast = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i + k - 1));
+        unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(
+            _mm256_and_si256(_mm256_cmpeq_epi8(first, blockFirst), _mm256_cmpeq_epi8(last, blockLast))));
+        while (mask != 0)
+        {
+            const size_t pos = i + std::countr_zero(mask);
+            if (std::memcmp(data + pos + 1, needle.data() + 1, k - 2) == 0)
+            {
+                return pos;
+            }
+            mask &= mask - 1;
+        }
+    }
+    return findSubstringSse2(haystack, needle, i);
+}
+#endif
+
+// Picks the widest scanner the running CPU supports (checked once per process)
+SubstringScanner selectSubstringScanner()
+{
+#if TASK_CLI_X86_SIMD
+    static const SubstringScanner scanner = __builtin_cpu_supports("avx2") ? findSubstringAvx2 : findSubstringSse2;
+    return scanner;
+#else
+    return findSubstringScalar;
+#endif
+}
+
+// Returns the rows (i.e. indices into the task vector) of all descriptions containing needle
+std::vector<size_t> searchDescriptions(const TaskColumns &columns, std::string_view needle,
+                                       SubstringScanner scanner = selectSubstringScanner())
+{
+    std::vector<size_t> matches;
+    const std::string_view blob = columns.descriptions;
+    const auto &offsets = columns.descriptionOffsets;
+    size_t pos = 0;
+    while ((pos = scanner(blob, needle, pos)) != std::string_view::npos)
+    {
+        // Map the hit back to the description it starts in
+        auto next = std::upper_bound(offsets.begin(), offsets.end(), pos);
+        size_t index = static_cast<size_t>(next - offsets.begin()) - 1;
+        if (index >= columns.size())
+        {
+            break;
+        }
+        if (pos + needle.size() <= offsets[index + 1])
+        {
+            matches.push_back(index);
+            pos = offsets[index + 1]; // One hit per task is enough, skip to the next description
+        }
+        else
+        {
+            pos++; // Hit straddles two descriptions, keep scanning
+        }
+    }
+    return matches;
+}
+
+void searchTasks(TaskStore &store, const std::string &needle)
+{
+    TraceSpan span("searchTasks");
+    if (needle.empty())
+    {
+        std::cerr << "Error: Search text cannot be empty." << std::endl;
+        return;
+    }
+
+    std::cout << "\n--- Tasks matching \"" << needle << "\" ---" << std::endl;
+
+    std::vector<size_t> matches = searchDescriptions(store.columns(DESCRIPTION_COLUMNS), needle);
+    for (size_t index : matches)
+    {
+        printTask(store.tasks[index]);
+    }
+
+    if (matches.empty())
+    {
+        std::cout << "No tasks found matching \"" << needle << "\"." << std::endl;
+        std::cout << "-------------" << std::endl;
+    }
+}
+
+// Handles 'count [todo|in-progress|done]': the number of tasks per status, or with one status
+void countTasks(TaskStore &store, const std::string &filter)
+{
+    TraceSpan span("countTasks");
+    StatusCounts counts = selectStatusKernels().count(store.columns().status);
+    if (std::optional<TaskStatus> status = parseStatus(filter))
+    {
+        std::cout << counts[static_cast<size_t>(*status)] << std::endl;
+        return;
+    }
+    std::cout << std::format("todo:        {}\n"
+                             "in-progress: {}\n"
+                             "done:        {}\n"
+                             "total:       {}\n",
+                             counts[0], counts[1], counts[2], store.tasks.size());
+}
+
+// --- Filter Expressions ---
+// 'list' accepts a small query language, compiled once into a flat program:
+//
+//   expr      := term ('or' term)*
+//   term      := factor ('and' factor)*
+//   factor    := 'not' factor | '(' expr ')' | predicate
+//   predicate := field op value
+//
+// Fields: status, id, created (createdAt), updated (updatedAt), desc (description).
+// Operators: ':' or '=' (equals), '!=', '<', '<=', '>', '>=', '~' (description contains).
+// Values containing spaces or operator characters must be double-quoted.
+// Example: status:todo and created>2025-04-01 and desc~"report"
+
+enum class QueryField
+{
+    Id,
+    Status,
+    Description,
+    CreatedAt,
+    UpdatedAt
+};
+
+// One comparison. Numeric and timestamp comparisons are normalized to "value in [lo, hi)",
+// optionally negated, so evaluation is a pair of integer compares.
+struct QueryPredicate
+{
+    QueryField field;
+    bool negate = false;
+    bool contains = false; // Description substring match instead of equality
+    long long lo = std::numeric_limits<long long>::min();
+    long long hi = std::numeric_limits<long long>::max();
+    TaskStatus status = TaskStatus::Todo;
+    std::string text; // Status or description operand
+};
+
+// Instructions of the compiled program. Each Test sets the accumulator; the jumps implement
+// short-circuit 'and'/'or' without materializing an expression tree at evaluation time.
+enum class QueryOpCode
+{
+    Test,        // acc = predicates[arg](task)
+    JumpIfFalse, // if (!acc) goto arg
+    JumpIfTrue,  // if (acc) goto arg
+    Not          // acc = !acc
+};
+
+struct QueryOp
+{
+    QueryOpCode code;
+    uint32_t arg;
+};
+
+struct CompiledQuery
+{
+    std::string source;
+    std::vector<QueryPredicate> predicates;
+    std::vector<QueryOp> program;
+    std::vector<uint32_t> requiredPredicates; // Predicates every match must satisfy (top-level 'and' terms)
+
+    bool matches(const TaskRow &row) const;
+
+    // Column groups the predicates read (see TaskStore::columns)
+    uint8_t columnGroups() const
+    {
+        uint8_t groups = 0;
+        for (const auto &predicate : predicates)
+        {
+            if (predicate.field == QueryField::CreatedAt || predicate.field == QueryField::UpdatedAt)
+            {
+                groups |= TIMESTAMP_COLUMNS;
+            }
+            else if (predicate.field == QueryField::Description)
+            {
+                groups |= DESCRIPTION_COLUMNS;
+            }
+        }
+        return groups;
+    }
+
+    // ANDs an extra predicate onto the whole program
+    void addConjunct(QueryPredicate predicate)
+    {
+        if (!program.empty())
+        {
+            program.push_back({QueryOpCode::JumpIfFalse, static_cast<uint32_t>(program.size() + 2)});
+        }
+        predicates.push_back(std::move(predicate));
+        requiredPredicates.push_back(static_cast<uint32_t>(predicates.size() - 1));
+        program.push_back({QueryOpCode::Test, static_cast<uint32_t>(predicates.size() - 1)});
+    }
+};
+
+// Recursive-descent compiler emitting QueryOps directly while parsing
+class QueryCompiler
+{
+public:
+    explicit QueryCompiler(std::string_view text) : input(text) {}
+
+    std::optional<CompiledQuery> compile(std::string &error)
+    {
+        query.source = std::string(input);
+        if (peek().kind == TokenKind::End && errorMessage.empty())
+        {
+            return std::move(query); // Empty expression matches every task
+        }
+        if (!parseExpr() || !expectEnd())
+        {
+            error = errorMessage;
+            return std::nullopt;
+        }
+        // Without 'or'/'not' the program is a plain conjunction, so every predicate is required
+        bool conjunctive = std::ranges::none_of(query.program, [](const QueryOp &op)
+                                                { return op.code == QueryOpCode::JumpIfTrue || op.code == QueryOpCode::Not; });
+        if (conjunctive)
+        {
+            for (uint32_t i = 0; i < query.predicates.size(); ++i)
+            {
+                query.requiredPredicates.push_back(i);
+            }
+        }
+        return std::move(query);
+    }
+
+private:
+    enum class TokenKind
+    {
+        End,
+        Word,   // Bare word or quoted string
+        Op,     // Comparison operator
+        LParen,
+        RParen
+    };
+
+    struct Token
+    {
+        TokenKind kind;
+        std::string text;
+        bool quoted = false;
+    };
+
+    std::string_view input;
+    size_t pos = 0;
+    std::optional<Token> lookahead;
+    CompiledQuery query;
+    std::string errorMessage;
+
+    bool fail(const std::string &message)
+    {
+        if (errorMessage.empty())
+        {
+            errorMessage = message;
+        }
+        return false;
+    }
+
+    static bool isOperatorChar(char c)
+    {
+        return c == ':' || c == '=' || c == '!' || c == '<' || c == '>' || c == '~';
+    }
+
+    Token readToken()
+    {
+        while (pos < input.size() && std::isspace(static_cast<unsigned char>(input[pos])))
+        {
+            pos++;
+        }
+        if (pos >= input.size())
+        {
+            return {TokenKind::End, ""};
+        }
+        char c = input[pos];
+        if (c == '(' || c == ')')
+        {
+            pos++;
+            return {c == '(' ? TokenKind::LParen : TokenKind::RParen, std::string(1, c)};
+        }
+        if (c == '"')
+        {
+            std::string text;
+            pos++;
+            while (pos < input.size() && input[pos] != '"')
+            {
+                if (input[pos] == '\\' && pos + 1 < input.size())
+                {
+                    pos++;
+                }
+                text += input[pos++];
+            }
+            if (pos >= input.size())
+            {
+                fail("unterminated quoted string");
+                return {TokenKind::End, ""};
+            }
+            pos++; // Closing quote
+            return {TokenKind::Word, text, true};
+        }
+        if (isOperatorChar(c))
+        {
+            // Two-character operators first
+            if (pos + 1 < input.size() && input[pos + 1] == '=' && (c == '!' || c == '<' || c == '>'))
+            {
+                pos += 2;
+                return {TokenKind::Op, std::string{c, '='}};
             }
+            pos++;
+            return {TokenKind::Op, std::string(1, c)};
+        }
+        size_t start = pos;
+        while (pos < input.size() && !std::isspace(static_cast<unsigned char>(input[pos])) && input[pos] != '(' &&
+               input[pos] != ')' && input[pos] != '"' && !isOperatorChar(input[pos]))
+        {
+            pos++;
+        }
+        return {TokenKind::Word, std::string(input.substr(start, pos - start))};
+    }
+
+    const Token &peek()
+    {
+        if (!lookahead)
+        {
+            lookahead = readToken();
+        }
+        return *lookahead;
+    }
+
+    Token next()
+    {
+        Token token = peek();
+        lookahead.reset();
+        return token;
+    }
+
+    bool peekKeyword(const char *keyword)
+    {
+        const Token &token = peek();
+        return token.kind == TokenKind::Word && !token.quoted && token.text == keyword;
+    }
+
+    uint32_t emit(QueryOpCode code, uint32_t arg = 0)
+    {
+        query.program.push_back({code, arg});
+        return static_cast<uint32_t>(query.program.size() - 1);
+    }
+
+    void patchJump(uint32_t at)
+    {
+        query.program[at].arg = static_cast<uint32_t>(query.program.size());
+    }
+
+    bool parseExpr()
+    {
+        if (!parseTerm())
+        {
+            return false;
+        }
+        std::vector<uint32_t> jumps;
+        while (peekKeyword("or"))
+        {
+            next();
+            jumps.push_back(emit(QueryOpCode::JumpIfTrue));
+            if (!parseTerm())
+            {
+                return false;
+            }
+        }
+        for (uint32_t jump : jumps)
+        {
+            patchJump(jump);
+        }
+        return true;
+    }
+
+    bool parseTerm()
+    {
+        if (!parseFactor())
+        {
+            return false;
+        }
+        std::vector<uint32_t> jumps;
+        while (peekKeyword("and"))
+        {
+            next();
+            jumps.push_back(emit(QueryOpCode::JumpIfFalse));
+            if (!parseFactor())
+            {
+                return false;
+            }
+        }
+        for (uint32_t jump : jumps)
+        {
+            patchJump(jump);
+        }
+        return true;
+    }
+
+    bool parseFactor()
+    {
+        if (peekKeyword("not"))
+        {
+            next();
+            if (!parseFactor())
+            {
+                return false;
+            }
+            emit(QueryOpCode::Not);
+            return true;
+        }
+        if (peek().kind == TokenKind::LParen)
+        {
+            next();
+            if (!parseExpr())
+            {
+                return false;
+            }
+            if (next().kind != TokenKind::RParen)
+            {
+                return fail("expected ')'");
+            }
+            return true;
+        }
+        return parsePredicate();
+    }
+
+    bool parsePredicate()
+    {
+        Token fieldToken = next();
+        if (fieldToken.kind != TokenKind::Word || fieldToken.quoted)
+        {
+            return fail(fieldToken.kind == TokenKind::End ? "expected a field name" : "expected a field name before '" + fieldToken.text + "'");
+        }
+        Token opToken = next();
+        if (opToken.kind != TokenKind::Op)
+        {
+            return fail("expected an operator after '" + fieldToken.text + "'");
+        }
+        Token valueToken = next();
+        if (valueToken.kind != TokenKind::Word)
+        {
+            return fail("expected a value after '" + fieldToken.text + opToken.text + "'");
+        }
 
-            if (updatedStr.empty())
+        QueryPredicate predicate;
+        const std::string &field = fieldToken.text;
+        const std::string &op = opToken.text;
+        const std::string &value = valueToken.text;
+        bool isEquality = (op == ":" || op == "=" || op == "!=");
+
+        if (field == "status")
+        {
+            predicate.field = QueryField::Status;
+            if (!isEquality)
+            {
+                return fail("status only supports ':', '=' and '!='");
+            }
+            if (value != "todo" && value != "in-progress" && value != "done")
+            {
+                return fail("invalid status '" + value + "'. Use 'todo', 'in-progress', or 'done'");
+            }
+            predicate.text = value;
+            predicate.status = *parseStatus(value);
+            predicate.negate = (op == "!=");
+        }
+        else if (field == "desc" || field == "description")
+        {
+            predicate.field = QueryField::Description;
+            if (!isEquality && op != "~")
+            {
+                return fail("desc only supports ':', '=', '!=' and '~'");
+            }
+            predicate.text = value;
+            predicate.contains = (op == "~");
+            predicate.negate = (op == "!=");
+        }
+        else
+        {
+            // Numeric and timestamp fields both reduce to a [start, end) range for the literal
+            TimeRange range;
+            if (field == "id")
+            {
+                predicate.field = QueryField::Id;
+                try
+                {
+                    size_t used = 0;
+                    long long id = std::stoll(value, &used);
+                    if (used != value.size())
+                    {
+                        throw std::invalid_argument(value);
+                    }
+                    // Task ids are ints; clamping just past their range keeps every comparison the
+                    // same and makes id + 1 safe
+                    id = std::clamp<long long>(id, std::numeric_limits<int>::min() - 1LL, std::numeric_limits<int>::max() + 1LL);
+                    range = {id, id + 1};
+                }
+                catch (const std::exception &)
+                {
+                    return fail("invalid id '" + value + "'");
+                }
+            }
+            else if (field == "created" || field == "createdAt" || field == "updated" || field == "updatedAt")
+            {
+                predicate.field = (field[0] == 'c') ? QueryField::CreatedAt : QueryField::UpdatedAt;
+                auto parsed = parseTimeRange(value);
+                if (!parsed)
+                {
+                    return fail("invalid timestamp '" + value + "'. Use YYYY-MM-DD or \"YYYY-MM-DD HH:MM:SS\"");
+                }
+                range = *parsed;
+            }
+            else
+            {
+                return fail("unknown field '" + field + "'");
+            }
+
+            if (op == ":" || op == "=" || op == "!=")
+            {
+                predicate.lo = range.start;
+                predicate.hi = range.end;
+                predicate.negate = (op == "!=");
+            }
+            else if (op == ">")
+            {
+                predicate.lo = range.end;
+            }
+            else if (op == ">=")
+            {
+                predicate.lo = range.start;
+            }
+            else if (op == "<")
+            {
+                predicate.hi = range.start;
+            }
+            else if (op == "<=")
             {
-                std::cerr << "Warning: Skipping task ID " << task.id << " due to missing updatedAt." << std::endl;
-                taskValid = false;
+                predicate.hi = range.end;
             }
             else
             {
-                task.updatedAt = updatedStr; // Use friend access
+                return fail("operator '" + op + "' is not supported for " + field);
+            }
+        }
+
+        query.predicates.push_back(std::move(predicate));
+        emit(QueryOpCode::Test, static_cast<uint32_t>(query.predicates.size() - 1));
+        return true;
+    }
+
+    bool expectEnd()
+    {
+        const Token &token = peek();
+        if (token.kind != TokenKind::End)
+        {
+            return fail("unexpected '" + token.text + "'");
+        }
+        return errorMessage.empty();
+    }
+};
+
+std::optional<CompiledQuery> compileQuery(std::string_view text, std::string &error)
+{
+    return QueryCompiler(text).compile(error);
+}
+
+// Predicates read the columnar copy, so timestamps are compared as numbers without reparsing
+bool evaluatePredicate(const QueryPredicate &predicate, const TaskRow &task)
+{
+    bool result = false;
+    switch (predicate.field)
+    {
+    case QueryField::Status:
+        result = (task.getStatusCode() == predicate.status);
+        break;
+    case QueryField::Description:
+        if (predicate.contains)
+        {
+            result = selectSubstringScanner()(task.getDescription(), predicate.text, 0) != std::string_view::npos;
+        }
+        else
+        {
+            result = (task.getDescription() == predicate.text);
+        }
+        break;
+    case QueryField::Id:
+        result = (task.getID() >= predicate.lo && task.getID() < predicate.hi);
+        break;
+    case QueryField::CreatedAt:
+    case QueryField::UpdatedAt:
+    {
+        long long time = (predicate.field == QueryField::CreatedAt) ? task.getCreatedTime() : task.getUpdatedTime();
+        result = time != TaskColumns::MISSING_TIME && time >= predicate.lo && time < predicate.hi;
+        break;
+    }
+    }
+    return result != predicate.negate;
+}
+
+bool CompiledQuery::matches(const TaskRow &task) const
+{
+    bool acc = true; // An empty program matches everything
+    for (size_t pc = 0; pc < program.size();)
+    {
+        const QueryOp &op = program[pc];
+        switch (op.code)
+        {
+        case QueryOpCode::Test:
+            acc = evaluatePredicate(predicates[op.arg], task);
+            break;
+        case QueryOpCode::JumpIfFalse:
+            if (!acc)
+            {
+                pc = op.arg;
+                continue;
+            }
+            break;
+        case QueryOpCode::JumpIfTrue:
+            if (acc)
+            {
+                pc = op.arg;
+                continue;
+            }
+            break;
+        case QueryOpCode::Not:
+            acc = !acc;
+            break;
+        }
+        pc++;
+    }
+    return acc;
+}
+
+// Runs a query, choosing the access path: if a required predicate is a created/updated
+// range, the narrowest such range is read from the timestamp index and only those tasks
+// are evaluated; otherwise every task is scanned. Matches are returned in storage order.
+std::vector<const Task *> runQuery(TaskStore &store, const CompiledQuery &query)
+{
+    TraceSpan span("runQuery");
+    std::vector<const Task *> matches;
+
+    std::optional<std::span<const TimestampIndex::Entry>> candidates;
+    for (uint32_t index : query.requiredPredicates)
+    {
+        const QueryPredicate &predicate = query.predicates[index];
+        if (predicate.negate || (predicate.field != QueryField::CreatedAt && predicate.field != QueryField::UpdatedAt))
+        {
+            continue;
+        }
+        TimestampField field = (predicate.field == QueryField::CreatedAt) ? TimestampField::CreatedAt : TimestampField::UpdatedAt;
+        auto range = store.timestampIndex(field).range(predicate.lo, predicate.hi);
+        if (!candidates || range.size() < candidates->size())
+        {
+            candidates = range;
+        }
+    }
+
+    if (!candidates)
+    {
+        const TaskColumns &columns = store.columns(query.columnGroups());
+        for (size_t i = 0; i < columns.size(); ++i)
+        {
+            if (query.matches(columns.row(i)))
+            {
+                matches.push_back(&store.tasks[i]);
+            }
+        }
+        return matches;
+    }
+
+    for (const auto &entry : *candidates)
+    {
+        const Task *task = store.find(entry.id);
+        if (task != nullptr && query.matches(store.rowOf(*task, query.columnGroups())))
+        {
+            matches.push_back(task);
+        }
+    }
+    std::ranges::sort(matches); // Pointers into the vector, so this restores storage order
+    return matches;
+}
+
+enum class SortKey
+{
+    None, // Storage order
+    Id,
+    CreatedAt,
+    UpdatedAt,
+    Description
+};
+
+struct ListOrder
+{
+    SortKey key = SortKey::None;
+    bool descending = false;
+    size_t limit = std::numeric_limits<size_t>::max();
+};
+
+// Walks an already built timestamp index in sort order, stopping after `limit` matches.
+// If the query restricts the same field to a range, only that slice of the index is walked.
+// Equal timestamps are visited in ascending id order in both directions, as selectTasks sorts them.
+std::vector<const Task *> orderByIndex(TaskStore &store, const TimestampIndex &index, QueryField field,
+                                       const CompiledQuery &query, const ListOrder &order)
+{
+    long long lo = std::numeric_limits<long long>::min();
+    long long hi = std::numeric_limits<long long>::max();
+    for (uint32_t i : query.requiredPredicates)
+    {
+        const QueryPredicate &predicate = query.predicates[i];
+        if (predicate.field == field && !predicate.negate)
+        {
+            lo = std::max(lo, predicate.lo);
+            hi = std::min(hi, predicate.hi);
+        }
+    }
+
+    std::vector<const Task *> matches;
+    auto visit = [&](const TimestampIndex::Entry &entry)
+    {
+        if (matches.size() >= order.limit)
+        {
+            return false;
+        }
+        const Task *task = store.find(entry.id);
+        if (task != nullptr && query.matches(store.rowOf(*task, query.columnGroups())))
+        {
+            matches.push_back(task);
+        }
+        return true;
+    };
+    auto slice = index.range(lo, hi);
+    if (order.descending)
+    {
+        // Walk runs of equal timestamps from the last one back, each run forwards
+        bool more = true;
+        for (auto end = slice.end(); more && end != slice.begin();)
+        {
+            auto start = std::ranges::lower_bound(slice.begin(), end, std::prev(end)->timestamp, {}, &TimestampIndex::Entry::timestamp);
+            for (auto it = start; it != end && (more = visit(*it)); ++it)
+            {
+            }
+            end = start;
+        }
+    }
+    else
+    {
+        for (auto it = slice.begin(); it != slice.end() && visit(*it); ++it)
+        {
+        }
+    }
+    return matches;
+}
+
+// Runs the query and applies sort order and limit. Top-K requests use std::partial_sort
+// (O(N log K)); sorting by a timestamp whose index is already built walks the index instead.
+std::vector<const Task *> selectTasks(TaskStore &store, const CompiledQuery &query, const ListOrder &order)
+{
+    if (order.key == SortKey::CreatedAt || order.key == SortKey::UpdatedAt)
+    {
+        bool created = (order.key == SortKey::CreatedAt);
+        const auto &index = created ? store.derived.createdIndex : store.derived.updatedIndex;
+        // Tasks with unparsable timestamps are not in the index, so it only covers complete stores
+        if (index && index->size() == store.tasks.size())
+        {
+            return orderByIndex(store, *index, created ? QueryField::CreatedAt : QueryField::UpdatedAt, query, order);
+        }
+    }
+
+    std::vector<const Task *> matches = runQuery(store, query);
+    if (order.key == SortKey::None)
+    {
+        if (matches.size() > order.limit)
+        {
+            matches.resize(order.limit);
+        }
+        return matches;
+    }
+
+    // Timestamps are compared as the seconds the index holds, so this order matches
+    // orderByIndex's; unparsable ones (never in the index) go last in either direction
+    const TaskColumns *columns = (order.key == SortKey::CreatedAt || order.key == SortKey::UpdatedAt)
+                                     ? &store.columns(TIMESTAMP_COLUMNS)
+                                     : nullptr;
+    auto seconds = [&](const Task *task)
+    {
+        size_t row = static_cast<size_t>(task - store.tasks.data());
+        return (order.key == SortKey::CreatedAt) ? columns->created[row] : columns->updated[row];
+    };
+
+    // Ties go by ascending id in either direction, as orderByIndex visits them
+    auto less = [&](const Task *a, const Task *b)
+    {
+        int cmp = 0;
+        switch (order.key)
+        {
+        case SortKey::Id:
+            cmp = (a->getID() > b->getID()) - (a->getID() < b->getID());
+            break;
+        case SortKey::CreatedAt:
+        case SortKey::UpdatedAt:
+        {
+            long long x = seconds(a);
+            long long y = seconds(b);
+            if ((x == TaskColumns::MISSING_TIME) != (y == TaskColumns::MISSING_TIME))
+            {
+                return y == TaskColumns::MISSING_TIME;
             }
+            cmp = (x > y) - (x < y);
+            break;
+        }
+        case SortKey::Description:
+            cmp = a->getDescription().compare(b->getDescription());
+            break;
+        case SortKey::None:
+            break;
+        }
+        if (cmp != 0)
+        {
+            return order.descending ? cmp > 0 : cmp < 0;
+        }
+        return a->getID() < b->getID();
+    };
+
+    if (order.limit < matches.size())
+    {
+        auto middle = matches.begin() + static_cast<std::ptrdiff_t>(order.limit);
+        std::partial_sort(matches.begin(), middle, matches.end(), less);
+        matches.erase(middle, matches.end());
+    }
+    else
+    {
+        std::sort(matches.begin(), matches.end(), less);
+    }
+    return matches;
+}
 
-            if (taskValid)
+void listTasks(TaskStore &store, const CompiledQuery &query, const ListOrder &order = {})
+{
+    TraceSpan span("listTasks");
+    std::cout << "\n--- Tasks (Filter: " << query.source << ") ---" << std::endl;
+
+    std::vector<const Task *> matches = selectTasks(store, query, order);
+    for (const Task *task : matches)
+    {
+        printTask(*task);
+    }
+
+    if (matches.empty())
+    {
+        std::cout << "No tasks found matching '" << query.source << "'." << std::endl;
+        std::cout << "-------------" << std::endl;
+    }
+}
+
+// Handles 'list [options] [filter|expression]'. Returns the process exit code.
+int listCommand(TaskStore &store, int argc, char *argv[])
+{
+    std::vector<QueryPredicate> rangePredicates;
+    std::vector<std::string> filterArgs;
+    std::string optionsText; // Range options as typed, for the listing header
+
+    ListOrder order;
+
+    for (int i = 2; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        if (arg == "--desc")
+        {
+            order.descending = true;
+            optionsText += (optionsText.empty() ? "" : " ") + arg;
+            continue;
+        }
+        if (arg == "--sort" || arg == "--limit")
+        {
+            if (i + 1 >= argc)
+            {
+                std::cerr << "Error: '" << arg << "' requires an argument." << std::endl;
+                return 1;
+            }
+            std::string value = argv[++i];
+            optionsText += (optionsText.empty() ? "" : " ") + arg + " " + value;
+            if (arg == "--limit")
+            {
+                bool isNumber = !value.empty() && value.size() <= 18 && std::ranges::all_of(value, [](char c) { return std::isdigit(static_cast<unsigned char>(c)) != 0; });
+                if (!isNumber)
+                {
+                    std::cerr << "Error: '--limit' requires a non-negative integer." << std::endl;
+                    return 1;
+                }
+                order.limit = std::stoull(value);
+            }
+            else if (value == "id")
+            {
+                order.key = SortKey::Id;
+            }
+            else if (value == "created")
+            {
+                order.key = SortKey::CreatedAt;
+            }
+            else if (value == "updated")
+            {
+                order.key = SortKey::UpdatedAt;
+            }
+            else if (value == "description")
+            {
+                order.key = SortKey::Description;
+            }
+            else
             {
-                tasks.push_back(task); // Add valid task to vector
+                std::cerr << "Error: Invalid sort key '" << value << "'. Use 'id', 'created', 'updated', or 'description'." << std::endl;
+                return 1;
             }
+            continue;
         }
-        catch (const std::invalid_argument &e)
+        bool isCreated = arg.starts_with("--created-");
+        bool isUpdated = arg.starts_with("--updated-");
+        if (!isCreated && !isUpdated)
         {
-            std::cerr << "Error parsing ID field as integer: " << e.what() << ". Skipping task fragment." << std::endl;
-            taskValid = false; // Ensure partially filled task isn't added
+            filterArgs.push_back(arg);
+            continue;
         }
-        catch (const std::out_of_range &e)
+
+        std::string kind = arg.substr(10); // "since", "before" or "between"
+        int valueCount = (kind == "between") ? 2 : 1;
+        if (kind != "since" && kind != "before" && kind != "between")
+        {
+            std::cerr << "Error: Unknown option '" << arg << "'." << std::endl;
+            return 1;
+        }
+        if (i + valueCount >= argc)
+        {
+            std::cerr << "Error: '" << arg << "' requires " << valueCount << " timestamp argument(s)." << std::endl;
+            return 1;
+        }
+        std::optional<TimeRange> from = parseTimeRange(argv[i + 1]);
+        std::optional<TimeRange> to = (valueCount == 2) ? parseTimeRange(argv[i + 2]) : from;
+        if (!from || !to)
+        {
+            std::cerr << "Error: Invalid timestamp for '" << arg << "'. Use YYYY-MM-DD or \"YYYY-MM-DD HH:MM:SS\"." << std::endl;
+            return 1;
+        }
+        for (int v = 0; v <= valueCount; ++v)
         {
-            std::cerr << "Error parsing ID field (out of range): " << e.what() << ". Skipping task fragment." << std::endl;
-            taskValid = false; // Ensure partially filled task isn't added
+            optionsText += (optionsText.empty() ? "" : " ") + std::string(argv[i + v]);
         }
+        i += valueCount;
 
-        currentPos = objEnd + 1; // Move past the parsed object
+        QueryPredicate predicate;
+        predicate.field = isCreated ? QueryField::CreatedAt : QueryField::UpdatedAt;
+        if (kind == "since")
+        {
+            predicate.lo = from->start;
+        }
+        else if (kind == "before")
+        {
+            predicate.hi = from->start;
+        }
+        else
+        {
+            predicate.lo = from->start;
+            predicate.hi = to->end; // The end bound is inclusive
+        }
+        rangePredicates.push_back(predicate);
     }
 
-    return tasks;
+    // Plain 'list' / 'list <status>' keep their original output
+    if (optionsText.empty() && filterArgs.size() <= 1)
+    {
+        std::string filter = filterArgs.empty() ? "all" : filterArgs[0];
+        if (filter == "all" || filter == "todo" || filter == "in-progress" || filter == "done")
+        {
+            listTasks(store, filter);
+            return 0;
+        }
+    }
+
+    // Anything else is a filter expression; join the arguments so quoting the whole
+    // expression is optional
+    std::string expression;
+    for (const auto &arg : filterArgs)
+    {
+        if (!expression.empty())
+        {
+            expression += ' ';
+        }
+        // A lone status keyword still works alongside range options
+        bool isStatus = (filterArgs.size() == 1 && (arg == "todo" || arg == "in-progress" || arg == "done"));
+        expression += isStatus ? "status:" + arg : arg;
+    }
+    if (expression == "all")
+    {
+        expression.clear();
+    }
+
+    std::string error;
+    auto query = compileQuery(expression, error);
+    if (!query)
+    {
+        std::cerr << "Error: Invalid filter '" << expression << "': " << error << "." << std::endl;
+        printUsage();
+        return 1;
+    }
+    for (auto &predicate : rangePredicates)
+    {
+        query->addConjunct(std::move(predicate));
+    }
+    if (!optionsText.empty())
+    {
+        query->source = expression.empty() ? optionsText : expression + " " + optionsText;
+    }
+    listTasks(store, *query, order);
+    return 0;
 }
 
-// --- JSON Saving (using getters) ---
-void saveTasks(const std::vector<Task> &tasks)
+// --- Statistics ---
+
+// Formats a duration in seconds as e.g. "3d 4h 12m"
+std::string formatAge(long long seconds)
 {
-    std::ofstream file(TASKS_FILE);
-    if (!file.is_open())
+    long long days = seconds / 86400;
+    long long hours = (seconds % 86400) / 3600;
+    long long minutes = (seconds % 3600) / 60;
+    if (days > 0)
     {
-        std::cerr << "Error: Could not open " << TASKS_FILE << " for writing." << std::endl;
-        // Consider throwing an exception or returning a bool status
-        return;
+        return std::format("{}d {}h {}m", days, hours, minutes);
     }
+    if (hours > 0)
+    {
+        return std::format("{}h {}m", hours, minutes);
+    }
+    return std::format("{}m", minutes);
+}
+
+// Formats a day number (days since 1970-01-01) as YYYY-MM-DD
+std::string formatDay(long long day)
+{
+    std::chrono::year_month_day ymd{std::chrono::sys_days{std::chrono::days{day}}};
+    return std::format("{:04}-{:02}-{:02}", static_cast<int>(ymd.year()), static_cast<unsigned>(ymd.month()),
+                       static_cast<unsigned>(ymd.day()));
+}
+
+// Nearest-rank percentile of values (which is partially reordered)
+long long percentile(std::vector<long long> &values, double p)
+{
+    size_t rank = static_cast<size_t>(std::ceil(p * static_cast<double>(values.size())));
+    size_t index = std::clamp<size_t>(rank, 1, values.size()) - 1;
+    std::nth_element(values.begin(), values.begin() + static_cast<std::ptrdiff_t>(index), values.end());
+    return values[index];
+}
+
+struct TaskStats
+{
+    size_t todo = 0;
+    size_t inProgress = 0;
+    size_t done = 0;
+    std::vector<long long> openAges; // Seconds since createdAt for todo/in-progress tasks
+    long long today = 0;             // Day number of "now"
+    std::vector<size_t> donePerDay;  // donePerDay[0] is today, [1] yesterday, ...
+};
 
-    file << "[\n";
-    for (size_t i = 0; i < tasks.size(); ++i)
+// Gathers everything 'stats' reports in a single pass. Completion time is taken from the
+// updatedAt of done tasks, since marking a task done is what last touched it.
+TaskStats computeStats(const TaskColumns &columns, int days)
+{
+    TaskStats stats;
+    long long now = parseTimeRange(getCurrentTimestamp())->start;
+    stats.today = now / 86400;
+    stats.donePerDay.assign(static_cast<size_t>(days), 0);
+
+    for (size_t i = 0; i < columns.size(); ++i)
     {
-        const auto &task = tasks[i];
-        file << "  {\n";
-        // Use getter methods to access task data
-        file << "    \"id\": " << task.getID() << ",\n";
-        file << "    \"description\": \"" << escapeJsonString(task.getDescription()) << "\",\n";
-        file << "    \"status\": \"" << escapeJsonString(task.getStatus()) << "\",\n";
-        file << "    \"createdAt\": \"" << escapeJsonString(task.getCreatedAt()) << "\",\n";
-        file << "    \"updatedAt\": \"" << escapeJsonString(task.getUpdatedAt()) << "\"\n";
-        file << "  }";
-        if (i < tasks.size() - 1)
+        TaskStatus status = columns.status[i];
+        if (status == TaskStatus::Done)
+        {
+            stats.done++;
+            if (long long updated = columns.updated[i]; updated != TaskColumns::MISSING_TIME)
+            {
+                long long daysAgo = stats.today - updated / 86400;
+                if (daysAgo >= 0 && daysAgo < days)
+                {
+                    stats.donePerDay[static_cast<size_t>(daysAgo)]++;
+                }
+            }
+            continue;
+        }
+
+        if (status == TaskStatus::Todo)
         {
-            file << ",\n"; // Comma between objects
+            stats.todo++;
         }
         else
         {
-            file << "\n"; // No comma after the last object
+            stats.inProgress++;
+        }
+        if (long long created = columns.created[i]; created != TaskColumns::MISSING_TIME)
+        {
+            stats.openAges.push_back(std::max(0LL, now - created));
         }
     }
-    file << "]\n";
-    file.close();
-    if (!file.good())
-    { // Check if any write errors occurred
-        std::cerr << "Error: An error occurred while writing to " << TASKS_FILE << "." << std::endl;
-    }
+    return stats;
 }
 
-// --- Task Management Logic (using Task class methods and C++20 features) ---
-int getNextId(const std::vector<Task> &tasks)
+void printStats(const TaskColumns &columns, int days, bool json)
 {
-    if (tasks.empty())
+    TaskStats stats = computeStats(columns, days);
+    size_t total = stats.todo + stats.inProgress + stats.done;
+
+    long long oldest = 0, median = 0, p95 = 0;
+    if (!stats.openAges.empty())
     {
-        return 1;
+        oldest = *std::ranges::max_element(stats.openAges);
+        median = percentile(stats.openAges, 0.5);
+        p95 = percentile(stats.openAges, 0.95);
     }
-    auto max_it = std::ranges::max_element(tasks, {}, &Task::getID);
-    // It's guaranteed to find an element if tasks is not empty
-    int maxId = max_it->getID(); // Dereference iterator to get Task, then get ID
-
-    if (maxId >= std::numeric_limits<int>::max())
+    size_t doneInWindow = 0;
+    for (size_t count : stats.donePerDay)
     {
-        throw std::overflow_error("Cannot generate new task ID, maximum integer value reached.");
+        doneInWindow += count;
     }
-    return maxId + 1;
-}
+    double averagePerDay = static_cast<double>(doneInWindow) / days;
 
-void addTask(std::vector<Task> &tasks, const std::string &description)
-{
-    if (description.empty())
+    if (json)
     {
-        std::cerr << "Error: Task description cannot be empty." << std::endl;
+        std::string perDay;
+        for (int i = days - 1; i >= 0; --i)
+        {
+            perDay += std::format("{}{{\"date\": \"{}\", \"done\": {}}}", perDay.empty() ? "" : ", ",
+                                  formatDay(stats.today - i), stats.donePerDay[static_cast<size_t>(i)]);
+        }
+        std::cout << std::format(
+            "{{\n"
+            "  \"counts\": {{\"todo\": {}, \"in-progress\": {}, \"done\": {}, \"total\": {}}},\n"
+            "  \"openAge\": {{\"count\": {}, \"oldestSeconds\": {}, \"medianSeconds\": {}, \"p95Seconds\": {}}},\n"
+            "  \"throughput\": {{\"days\": {}, \"averagePerDay\": {:.2f}, \"perDay\": [{}]}}\n"
+            "}}\n",
+            stats.todo, stats.inProgress, stats.done, total,
+            stats.openAges.size(), oldest, median, p95,
+            days, averagePerDay, perDay);
         return;
     }
-    try
+
+    std::cout << "\n--- Task Statistics ---" << std::endl;
+    std::cout << std::format("  todo:        {}\n"
+                             "  in-progress: {}\n"
+                             "  done:        {}\n"
+                             "  total:       {}\n",
+                             stats.todo, stats.inProgress, stats.done, total);
+    std::cout << "Open task age (" << stats.openAges.size() << " tasks):" << std::endl;
+    if (stats.openAges.empty())
     {
-        int newId = getNextId(tasks);
-        // Use the Task constructor that sets timestamps etc.
-        Task newTask(newId, description);
-        tasks.push_back(newTask);
-        saveTasks(tasks);
-        std::cout << "Task added successfully (ID: " << newId << ")" << std::endl;
+        std::cout << "  No open tasks." << std::endl;
     }
-    catch (const std::overflow_error &e)
+    else
     {
-        std::cerr << "Error adding task: " << e.what() << std::endl;
+        std::cout << std::format("  oldest: {}\n  median: {}\n  p95:    {}\n",
+                                 formatAge(oldest), formatAge(median), formatAge(p95));
+    }
+    std::cout << "Completed per day (last " << days << " days):" << std::endl;
+    for (int i = days - 1; i >= 0; --i)
+    {
+        std::cout << std::format("  {}: {}\n", formatDay(stats.today - i), stats.donePerDay[static_cast<size_t>(i)]);
     }
+    std::cout << std::format("  average: {:.2f}/day\n", averagePerDay);
+    std::cout << "-------------" << std::endl;
 }
 
-void updateTask(std::vector<Task> &tasks, int id, const std::string &newDescription)
+// --- Synthetic Store Generator ---
+// 'gen' writes stores of arbitrary size for scaling tests and benchmarks. Output depends only
+// on the options (including the seed), so a store can be recreated exactly from its command line.
+
+struct GenOptions
 {
-    if (newDescription.empty())
+    size_t count = 1000;
+    uint64_t seed = 1;
+    double mix[3] = {1, 1, 1};    // Relative weights of todo, in-progress, done
+    size_t minDescLength = 10;    // Description length range in bytes
+    size_t maxDescLength = 60;
+    double escapeDensity = 0.0;   // Probability per word of containing a character that needs escaping
+    double unicodeDensity = 0.0;  // Probability per word of being non-ASCII UTF-8
+    long long startTime = 1735689600; // 2025-01-01 00:00:00; createdAt is spread over [startTime, startTime + spreadDays)
+    int spreadDays = 30;
+};
+
+// SplitMix64: small, fast and, unlike the <random> distributions, identical on every platform
+struct SplitMix64
+{
+    uint64_t state;
+
+    uint64_t next()
     {
-        std::cerr << "Error: New task description cannot be empty." << std::endl;
-        return;
+        uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
     }
-    auto it = std::ranges::find_if(tasks, [id](const Task &task)
-                                   { return task.getID() == id; });
 
-    if (it != tasks.end())
-    {                                       // Check if the iterator is valid (task found)
-        it->setDescription(newDescription); // Use setter via iterator (setter updates timestamp)
-        saveTasks(tasks);
-        std::cout << "Task " << id << " updated successfully." << std::endl;
+    uint64_t below(uint64_t bound) { return bound == 0 ? 0 : next() % bound; }
+
+    double unit() { return static_cast<double>(next() >> 11) * 0x1.0p-53; }
+};
+
+// Formats seconds since the epoch as "YYYY-MM-DD HH:MM:SS" (inverse of parseTimeRange)
+std::string formatTimestamp(long long seconds)
+{
+    long long day = (seconds >= 0 ? seconds : seconds - 86399) / 86400;
+    long long secondOfDay = seconds - day * 86400;
+    return std::format("{} {:02}:{:02}:{:02}", formatDay(day), secondOfDay / 3600, (secondOfDay % 3600) / 60,
+                       secondOfDay % 60);
+}
+
+std::string generateDescription(SplitMix64 &random, const GenOptions &options)
+{
+    static const char *words[] = {"buy", "groceries", "finish", "project", "report", "call", "schedule",
+                                  "dentist", "appointment", "read", "book", "plan", "weekend", "trip",
+                                  "review", "pull", "request", "write", "docs", "fix", "bug", "deploy"};
+    static const char *unicodeWords[] = {"caf\u00e9", "na\u00efve", "\u00fcber", "\u65e5\u672c",
+                                         "\u0434\u043e\u043c", "\U0001F600"};
+    static const char *escapedWords[] = {"\"quoted\"", "C:\\temp", "a\\b", "say \"hi\"", "line\nbreak", "tab\tstop"};
+
+    size_t target = options.minDescLength + random.below(options.maxDescLength - options.minDescLength + 1);
+    std::string description;
+    while (description.size() < target)
+    {
+        if (!description.empty())
+        {
+            description += ' ';
+        }
+        double roll = random.unit();
+        if (roll < options.escapeDensity)
+        {
+            description += escapedWords[random.below(std::size(escapedWords))];
+        }
+        else if (roll < options.escapeDensity + options.unicodeDensity)
+        {
+            description += unicodeWords[random.below(std::size(unicodeWords))];
+        }
+        else
+        {
+            description += words[random.below(std::size(words))];
+        }
     }
-    else
+    // Trim back to the target length without splitting a UTF-8 sequence
+    size_t cut = std::min(description.size(), std::max<size_t>(target, 1));
+    while (cut < description.size() && (static_cast<unsigned char>(description[cut]) & 0xC0) == 0x80)
     {
-        std::cerr << "Error: Task with ID " << id << " not found for update." << std::endl;
+        cut++;
+    }
+    description.resize(cut);
+    // Drop a trailing space left by the cut
+    while (description.size() > 1 && description.back() == ' ')
+    {
+        description.pop_back();
     }
+    return description;
 }
 
-void deleteTask(std::vector<Task> &tasks, int id)
+TaskList generateTasks(const GenOptions &options, std::pmr::memory_resource *resource = std::pmr::get_default_resource())
 {
-    size_t numRemoved = std::erase_if(tasks, [id](const Task &task)
-                                      { return task.getID() == id; }); // Use getter in lambda
+    SplitMix64 random{options.seed};
+    double totalWeight = options.mix[0] + options.mix[1] + options.mix[2];
+    long long spreadSeconds = static_cast<long long>(options.spreadDays) * 86400;
 
-    if (numRemoved > 0)
-    { // Check if any elements were actually removed
-        saveTasks(tasks);
-        std::cout << "Task " << id << " deleted successfully." << std::endl;
-    }
-    else
+    TaskList tasks(resource);
+    tasks.reserve(options.count);
+    for (size_t i = 0; i < options.count; ++i)
     {
-        std::cerr << "Error: Task with ID " << id << " not found for deletion." << std::endl;
+        double roll = random.unit() * totalWeight;
+        size_t status = (roll < options.mix[0]) ? 0 : (roll < options.mix[0] + options.mix[1]) ? 1 : 2;
+
+        long long created = options.startTime + static_cast<long long>(random.below(static_cast<uint64_t>(spreadSeconds)));
+        long long remaining = options.startTime + spreadSeconds - created;
+        long long updated = created + static_cast<long long>(random.below(static_cast<uint64_t>(remaining)));
+
+        tasks.emplace_back(static_cast<int>(i + 1), generateDescription(random, options), static_cast<TaskStatus>(status),
+                           formatTimestamp(created), formatTimestamp(updated));
     }
+    return tasks;
 }
 
-void markTaskStatus(std::vector<Task> &tasks, int id, const std::string &status)
+// Parses the 'gen' arguments into options. Returns false (after printing an error) on bad input.
+bool parseGenOptions(int argc, char *argv[], GenOptions &options, bool &force)
 {
-    // Basic validation of the status string remains useful
-    if (status != "todo" && status != "in-progress" && status != "done")
+    if (argc < 3)
     {
-        std::cerr << "Error: Invalid status '" << status << "'. Use 'todo', 'in-progress', or 'done'." << std::endl;
-        return;
+        std::cerr << "Error: 'gen' command requires a task count." << std::endl;
+        return false;
     }
-    auto it = std::ranges::find_if(tasks, [id](const Task &task)
-                                   { return task.getID() == id; });
+    try
+    {
+        options.count = std::stoull(argv[2]);
+        if (options.count > static_cast<size_t>(std::numeric_limits<int>::max()))
+        {
+            std::cerr << "Error: Task count exceeds the maximum task ID." << std::endl;
+            return false;
+        }
 
-    if (it != tasks.end())
-    {                          // Check if found
-        it->setStatus(status); // Use setter via iterator (setter validates & handles timestamp)
-        saveTasks(tasks);
-        // The setStatus method now prints warnings, so a simple notification is sufficient
-        std::cout << "Task " << id << " status updated." << std::endl; // Message adjusted slightly
+        for (int i = 3; i < argc; ++i)
+        {
+            std::string arg = argv[i];
+            if (arg == "--force")
+            {
+                force = true;
+                continue;
+            }
+            if (i + 1 >= argc)
+            {
+                std::cerr << "Error: Unknown option or missing value: '" << arg << "'." << std::endl;
+                return false;
+            }
+            std::string value = argv[++i];
+            if (arg == "--seed")
+            {
+                options.seed = std::stoull(value);
+            }
+            else if (arg == "--mix")
+            {
+                // todo:in-progress:done weights, e.g. 3:2:5
+                char sep1 = 0, sep2 = 0;
+                std::istringstream in(value);
+                in >> options.mix[0] >> sep1 >> options.mix[1] >> sep2 >> options.mix[2];
+                if (!in || sep1 != ':' || sep2 != ':' || options.mix[0] < 0 || options.mix[1] < 0 ||
+                    options.mix[2] < 0 || options.mix[0] + options.mix[1] + options.mix[2] <= 0)
+                {
+                    std::cerr << "Error: '--mix' expects three non-negative weights like 3:2:5." << std::endl;
+                    return false;
+                }
+            }
+            else if (arg == "--desc-len")
+            {
+                // min-max in bytes
+                size_t dash = value.find('-');
+                options.minDescLength = std::stoull(value.substr(0, dash));
+                options.maxDescLength = (dash == std::string::npos) ? options.minDescLength : std::stoull(value.substr(dash + 1));
+                if (options.minDescLength < 1 || options.maxDescLength < options.minDescLength)
+                {
+                    std::cerr << "Error: '--desc-len' expects a range like 10-60 (minimum 1)." << std::endl;
+                    return false;
+                }
+            }
+            else if (arg == "--escape-density" || arg == "--unicode-density")
+            {
+                double density = std::stod(value);
+                if (density < 0 || density > 1)
+                {
+                    std::cerr << "Error: '" << arg << "' must be between 0 and 1." << std::endl;
+                    return false;
+                }
+                (arg == "--escape-density" ? options.escapeDensity : options.unicodeDensity) = density;
+            }
+            else if (arg == "--start")
+            {
+                auto start = parseTimeRange(value);
+                if (!start)
+                {
+                    std::cerr << "Error: '--start' expects YYYY-MM-DD." << std::endl;
+                    return false;
+                }
+                options.startTime = start->start;
+            }
+            else if (arg == "--days")
+            {
+                options.spreadDays = std::stoi(value);
+                if (options.spreadDays < 1)
+                {
+                    std::cerr << "Error: '--days' must be at least 1." << std::endl;
+                    return false;
+                }
+            }
+            else
+            {
+                std::cerr << "Error: Unknown option '" << arg << "' for 'gen'." << std::endl;
+                return false;
+            }
+        }
     }
-    else
+    catch (const std::logic_error &)
     {
-        std::cerr << "Error: Task with ID " << id << " not found to mark status." << std::endl;
+        // std::invalid_argument / std::out_of_range from the numeric conversions
+        std::cerr << "Error: Invalid number in 'gen' arguments." << std::endl;
+        return false;
+    }
+    if (options.escapeDensity + options.unicodeDensity > 1)
+    {
+        std::cerr << "Error: '--escape-density' and '--unicode-density' must add up to at most 1." << std::endl;
+        return false;
     }
+    return true;
 }
 
-void listTasks(const std::vector<Task> &tasks, const std::string &filter = "all")
+void printUsage()
 {
-    std::cout << "\n--- Tasks";
-    if (filter != "all")
+    // Using std::format with a raw string literal for easier multiline formatting
+    std::cout << std::format(R"(
+Usage: task-cli [--stats[=json]] [--trace <file>] <command> [options]
+
+Commands:
+  add <"description">        Add a new task (use quotes for descriptions with spaces)
+  update <id> <"description">  Update task description (use quotes)
+  delete <id>                Delete a task by ID
+  show <id>                  Show one task
+  mark-in-progress <id>    Mark task as 'in-progress'
+  mark-done <id>             Mark task as 'done'
+  mark-todo <id>             Mark task as 'todo'
+  list [all|todo|in-progress|done]  List tasks (default: all)
+  list <expression>          List tasks matching a filter expression, e.g.
+                             'status:todo and created>2025-04-01 and desc~"report"'
+  list [--created-since <t>] [--created-before <t>] [--created-between <t1> <t2>]
+       [--updated-since <t>] [--updated-before <t>] [--updated-between <t1> <t2>] [filter]
+                             List tasks by timestamp range (t: YYYY-MM-DD or "YYYY-MM-DD HH:MM:SS")
+  list [--sort id|created|updated|description] [--desc] [--limit <k>] [filter]
+                             Sort the listing and/or show only the first k tasks
+  search <"text">            List tasks whose description contains the text
+  count [todo|in-progress|done]  Show the number of tasks per status, or with the given status
+  stats [--days <n>] [--json]  Show counts per status, open task age and completions per day
+  gen <count> [--seed <n>] [--mix <todo:in-progress:done>] [--desc-len <min-max>]
+      [--escape-density <p>] [--unicode-density <p>] [--start <YYYY-MM-DD>] [--days <n>] [--force]
+                             Replace the store with <count> generated tasks (for load tests)
+  format [json|ndjson|sharded]  Show the store format, or rewrite the store in the given format
+  batch [file|-]             Run commands from a file or stdin (one per line) against one loaded store
+  metrics [--json]           Show p50/p99/p99.9/max latency per operation run in this process
+                             (use as a line in a batch)
+  help                       Show this help message
+
+Global options:
+  --stats[=json]             Print time per phase, bytes read/written and heap allocations to stderr
+  --trace <file>             Write a Chrome trace-event JSON file (chrome://tracing, ui.perfetto.dev)
+  --mem-cap <N[K|M|G]>       Fail instead of letting the loaded store grow past N bytes
+  --no-cache                 Always parse tasks.json; do not read or write tasks.json.cache
+
+Example:
+  ./task-cli add "Submit project report"
+  ./task-cli list todo
+  ./task-cli list 'status:in-progress or updated>=2025-04-10'
+  ./task-cli mark-in-progress 1
+
+Note: Task descriptions containing spaces must be enclosed in double quotes.
+)");
+}
+
+// --- Operation Latency Metrics ---
+// Every command dispatched by runCommand() (once per process, or once per line in 'batch'
+// mode) is recorded into a per-operation latency histogram, dumped by the 'metrics' command.
+
+// HDR-style log-linear histogram of nanosecond latencies: 64 linear sub-buckets per power of
+// two, so any recorded value is reported within ~1.6%. Recording is lock-free (relaxed
+// atomic increments), so it can be shared between threads.
+class LatencyHistogram
+{
+public:
+    static constexpr int SUB_BUCKET_BITS = 6;
+    static constexpr uint64_t SUB_BUCKETS = 1ULL << SUB_BUCKET_BITS;
+    static constexpr size_t BUCKET_COUNT = SUB_BUCKETS * (64 - SUB_BUCKET_BITS + 1);
+
+    void record(uint64_t valueNs)
     {
-        std::cout << " (Status: " << filter << ")";
+        buckets[bucketIndex(valueNs)].fetch_add(1, std::memory_order_relaxed);
+        count.fetch_add(1, std::memory_order_relaxed);
+        uint64_t seen = maxNs.load(std::memory_order_relaxed);
+        while (valueNs > seen && !maxNs.compare_exchange_weak(seen, valueNs, std::memory_order_relaxed))
+        {
+        }
     }
-    std::cout << " ---" << std::endl;
 
-    bool tasksDisplayed = false;
-    // Looping can stay simple, or could use std::views::filter etc.
-    // Sticking to simple loop for clarity comparison with original.
-    for (const auto &task : tasks)
-    {
-        // Use getter for filtering
-        bool matchFilter = (filter == "all" || task.getStatus() == filter);
-        if (matchFilter)
+    uint64_t totalCount() const { return count.load(std::memory_order_relaxed); }
+    uint64_t max() const { return maxNs.load(std::memory_order_relaxed); }
+
+    // Highest value equivalent to the bucket holding the given quantile (0..1)
+    uint64_t valueAtQuantile(double quantile) const
+    {
+        uint64_t total = totalCount();
+        if (total == 0)
+        {
+            return 0;
+        }
+        uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(quantile * static_cast<double>(total))));
+        uint64_t seen = 0;
+        for (size_t i = 0; i < BUCKET_COUNT; ++i)
+        {
+            seen += buckets[i].load(std::memory_order_relaxed);
+            if (seen >= rank)
+            {
+                return std::min(bucketUpperBound(i), max());
+            }
+        }
+        return max();
+    }
+
+private:
+    std::atomic<uint64_t> buckets[BUCKET_COUNT] = {};
+    std::atomic<uint64_t> count{0};
+    std::atomic<uint64_t> maxNs{0};
+
+    static size_t bucketIndex(uint64_t value)
+    {
+        if (value < SUB_BUCKETS)
+        {
+            return static_cast<size_t>(value);
+        }
+        int shift = std::bit_width(value) - 1 - SUB_BUCKET_BITS; // Keep the top SUB_BUCKET_BITS + 1 bits
+        return static_cast<size_t>(SUB_BUCKETS * (shift + 1) + ((value >> shift) - SUB_BUCKETS));
+    }
+
+    static uint64_t bucketUpperBound(size_t index)
+    {
+        if (index < SUB_BUCKETS)
+        {
+            return index;
+        }
+        uint64_t shift = index / SUB_BUCKETS - 1;
+        uint64_t sub = index % SUB_BUCKETS + SUB_BUCKETS;
+        return ((sub + 1) << shift) - 1;
+    }
+};
+
+// Operations with their own histogram; anything else is recorded under "other"
+const char *const METRIC_OPERATIONS[] = {"add", "update", "delete", "mark-in-progress", "mark-done", "mark-todo",
+                                         "show", "list", "search", "count", "stats", "other"};
+
+struct OperationMetrics
+{
+    LatencyHistogram histograms[std::size(METRIC_OPERATIONS)];
+
+    void record(std::string_view command, uint64_t ns)
+    {
+        size_t index = std::size(METRIC_OPERATIONS) - 1;
+        for (size_t i = 0; i + 1 < std::size(METRIC_OPERATIONS); ++i)
+        {
+            if (command == METRIC_OPERATIONS[i])
+            {
+                index = i;
+                break;
+            }
+        }
+        histograms[index].record(ns);
+    }
+
+    void print(bool json) const
+    {
+        auto us = [](uint64_t ns)
+        { return static_cast<double>(ns) / 1e3; };
+
+        std::string rows;
+        for (size_t i = 0; i < std::size(METRIC_OPERATIONS); ++i)
+        {
+            const LatencyHistogram &h = histograms[i];
+            if (h.totalCount() == 0)
+            {
+                continue;
+            }
+            if (json)
+            {
+                rows += std::format("{}\"{}\": {{\"count\": {}, \"p50Us\": {:.1f}, \"p99Us\": {:.1f}, \"p999Us\": {:.1f}, \"maxUs\": {:.1f}}}",
+                                    rows.empty() ? "" : ", ", METRIC_OPERATIONS[i], h.totalCount(),
+                                    us(h.valueAtQuantile(0.5)), us(h.valueAtQuantile(0.99)),
+                                    us(h.valueAtQuantile(0.999)), us(h.max()));
+            }
+            else
+            {
+                rows += std::format("  {:<17} {:>8} {:>12.1f} {:>12.1f} {:>12.1f} {:>12.1f}\n", METRIC_OPERATIONS[i],
+                                    h.totalCount(), us(h.valueAtQuantile(0.5)), us(h.valueAtQuantile(0.99)),
+                                    us(h.valueAtQuantile(0.999)), us(h.max()));
+            }
+        }
+
+        if (json)
         {
-            tasksDisplayed = true;
-            // Use getters for display - using std::format for cleaner output
-            std::cout << std::format(
-                "ID: {}\n"
-                "  Description: {}\n"
-                "  Status: {}\n"
-                "  Created: {}\n"
-                "  Updated: {}\n"
-                "-------------\n",
-                task.getID(),
-                task.getDescription(),
-                task.getStatus(),
-                task.getCreatedAt(),
-                task.getUpdatedAt());
+            std::cout << "{" << rows << "}" << std::endl;
+            return;
         }
-    }
-
-    if (!tasksDisplayed)
-    {
-        if (filter == "all")
+        std::cout << "\n--- Operation Latency (us) ---" << std::endl;
+        if (rows.empty())
         {
-            std::cout << "No tasks found." << std::endl;
+            std::cout << "No operations recorded." << std::endl;
         }
         else
         {
-            std::cout << "No tasks found with status '" << filter << "'." << std::endl;
+            std::cout << std::format("  {:<17} {:>8} {:>12} {:>12} {:>12} {:>12}\n", "operation", "count", "p50", "p99",
+                                     "p99.9", "max")
+                      << rows;
         }
         std::cout << "-------------" << std::endl;
     }
-}
-
-void printUsage()
-{
-    // Using std::format with a raw string literal for easier multiline formatting
-    std::cout << std::format(R"(
-Usage: task-cli <command> [options]
-
-Commands:
-  add <"description">        Add a new task (use quotes for descriptions with spaces)
-  update <id> <"description">  Update task description (use quotes)
-  delete <id>                Delete a task by ID
-  mark-in-progress <id>    Mark task as 'in-progress'
-  mark-done <id>             Mark task as 'done'
-  mark-todo <id>             Mark task as 'todo'
-  list [all|todo|in-progress|done]  List tasks (default: all)
-  help                       Show this help message
-
-Example:
-  ./task-cli add "Submit project report"
-  ./task-cli list todo
-  ./task-cli mark-in-progress 1
+};
 
-Note: Task descriptions containing spaces must be enclosed in double quotes.
-)");
-}
+OperationMetrics operationMetrics;
 
-// --- Main Application Logic ---
-int main(int argc, char *argv[])
+// Splits a batch line into arguments: whitespace separated, with double quotes grouping
+// words and backslash escaping the next character inside quotes
+std::vector<std::string> splitCommandLine(const std::string &line)
 {
-    // Check for help command or insufficient arguments
-    if (argc < 2 || std::string(argv[1]) == "help" || std::string(argv[1]) == "--help")
+    std::vector<std::string> args;
+    std::string current;
+    bool inArg = false;
+    bool inQuotes = false;
+    for (size_t i = 0; i < line.size(); ++i)
     {
-        printUsage();
-        return (argc < 2); // Return 1 if no command given, 0 if 'help' was explicitly asked for
+        char c = line[i];
+        if (inQuotes)
+        {
+            if (c == '\\' && i + 1 < line.size())
+            {
+                current += line[++i];
+            }
+            else if (c == '"')
+            {
+                inQuotes = false;
+            }
+            else
+            {
+                current += c;
+            }
+        }
+        else if (c == '"')
+        {
+            inQuotes = true;
+            inArg = true;
+        }
+        else if (std::isspace(static_cast<unsigned char>(c)))
+        {
+            if (inArg)
+            {
+                args.push_back(current);
+                current.clear();
+                inArg = false;
+            }
+        }
+        else
+        {
+            current += c;
+            inArg = true;
+        }
     }
-
-    std::vector<Task> tasks;
-    try
+    if (inArg)
     {
-        tasks = loadTasks(); // Load tasks at the beginning
+        args.push_back(current);
     }
-    catch (const std::exception &e)
+    return args;
+}
+
+int runCommand(TaskStore &store, int argc, char *argv[]);
+
+// Runs commands from `input`, one per line, against the already loaded store. Blank lines
+// and lines starting with '#' are skipped. Returns 1 if any command failed.
+int runBatch(TaskStore &store, std::istream &input)
+{
+    int exitCode = 0;
+    std::string line;
+    while (std::getline(input, line))
     {
-        std::cerr << "Fatal Error during task loading: " << e.what() << std::endl;
-        return 1; // Exit if loading fails critically
+        std::vector<std::string> words = splitCommandLine(line);
+        if (words.empty() || words[0].starts_with("#"))
+        {
+            continue;
+        }
+        if (words[0] == "batch")
+        {
+            std::cerr << "Error: 'batch' cannot be nested." << std::endl;
+            exitCode = 1;
+            continue;
+        }
+
+        std::vector<char *> args;
+        std::string program = "task-cli";
+        args.push_back(program.data());
+        for (auto &word : words)
+        {
+            args.push_back(word.data());
+        }
+        args.push_back(nullptr);
+        if (runCommand(store, static_cast<int>(words.size() + 1), args.data()) != 0)
+        {
+            exitCode = 1;
+        }
     }
+    return exitCode;
+}
 
+// Runs one command against the loaded store and records its latency. Called once by main(),
+// or once per line in 'batch' mode. Returns the exit code for the command.
+int runCommand(TaskStore &store, int argc, char *argv[])
+{
+    auto commandStart = std::chrono::steady_clock::now();
     std::string command = argv[1];
     int exitCode = 0; // Default to success
 
     try // Main command processing block
     {
-        if (command == "add")
+        TraceSpan commandSpan(traceRecorder.intern(command));
+        PhaseTimer operationTimer(Phase::Operation);
+
+        if (command == "help" || command == "--help")
+        {
+            printUsage();
+        }
+        else if (command == "add")
         {
             if (argc != 3)
             {
@@ -696,37 +5511,12 @@ int main(int argc, char *argv[])
             }
             else
             {
-                addTask(tasks, argv[2]);
+                addTask(store, argv[2]);
             }
         }
         else if (command == "list")
         {
-            std::string filter = "all";
-            if (argc >= 3)
-            { // Allow filter argument
-                filter = argv[2];
-                // Validate filter
-                if (filter != "all" && filter != "todo" && filter != "in-progress" && filter != "done")
-                {
-                    std::cerr << "Error: Invalid filter '" << filter << "'. Use 'all', 'todo', 'in-progress', or 'done'." << std::endl;
-                    printUsage();
-                    exitCode = 1;
-                }
-                else if (argc > 3) // Check for too many arguments
-                {
-                    std::cerr << "Error: 'list' command takes at most one argument (filter)." << std::endl;
-                    printUsage();
-                    exitCode = 1;
-                }
-                else
-                {
-                    listTasks(tasks, filter); // Call with valid filter
-                }
-            }
-            else
-            {                             // No filter provided
-                listTasks(tasks, filter); // Call with default "all" filter
-            }
+            exitCode = listCommand(store, argc, argv);
         }
         else if (command == "update")
         {
@@ -739,7 +5529,7 @@ int main(int argc, char *argv[])
             else
             {
                 int id = std::stoi(argv[2]); // stoi can throw
-                updateTask(tasks, id, argv[3]);
+                updateTask(store, id, argv[3]);
             }
         }
         else if (command == "delete")
@@ -753,7 +5543,7 @@ int main(int argc, char *argv[])
             else
             {
                 int id = std::stoi(argv[2]); // stoi can throw
-                deleteTask(tasks, id);
+                deleteTask(store, id);
             }
         }
         else if (command == "mark-in-progress")
@@ -767,7 +5557,7 @@ int main(int argc, char *argv[])
             else
             {
                 int id = std::stoi(argv[2]); // stoi can throw
-                markTaskStatus(tasks, id, "in-progress");
+                markTaskStatus(store, id, "in-progress");
             }
         }
         else if (command == "mark-done")
@@ -781,7 +5571,7 @@ int main(int argc, char *argv[])
             else
             {
                 int id = std::stoi(argv[2]); // stoi can throw
-                markTaskStatus(tasks, id, "done");
+                markTaskStatus(store, id, "done");
             }
         }
         else if (command == "mark-todo")
@@ -795,10 +5585,171 @@ int main(int argc, char *argv[])
             else
             {
                 int id = std::stoi(argv[2]); // stoi can throw
-                markTaskStatus(tasks, id, "todo");
+                markTaskStatus(store, id, "todo");
+            }
+        }
+        else if (command == "show")
+        {
+            if (argc != 3)
+            {
+                std::cerr << "Error: 'show' command requires one argument (id)." << std::endl;
+                printUsage();
+                exitCode = 1;
+            }
+            else
+            {
+                int id = std::stoi(argv[2]); // stoi can throw
+                showTask(store, id);
+            }
+        }
+        else if (command == "search")
+        {
+            if (argc != 3)
+            {
+                std::cerr << "Error: 'search' command requires exactly one argument (text)." << std::endl;
+                printUsage();
+                exitCode = 1;
+            }
+            else
+            {
+                searchTasks(store, argv[2]);
+            }
+        }
+        else if (command == "count")
+        {
+            std::string filter = (argc == 3) ? argv[2] : "all";
+            if (argc > 3 || (filter != "all" && !parseStatus(filter)))
+            {
+                std::cerr << "Error: 'count' takes at most one status (todo, in-progress or done)." << std::endl;
+                exitCode = 1;
+            }
+            else
+            {
+                countTasks(store, filter);
+            }
+        }
+        else if (command == "stats")
+        {
+            int days = 7;
+            bool json = false;
+            for (int i = 2; i < argc && exitCode == 0; ++i)
+            {
+                std::string arg = argv[i];
+                if (arg == "--json")
+                {
+                    json = true;
+                }
+                else if (arg == "--days" && i + 1 < argc)
+                {
+                    std::string value = argv[++i];
+                    bool isNumber = !value.empty() && value.size() <= 4 && std::ranges::all_of(value, [](char c) { return std::isdigit(static_cast<unsigned char>(c)) != 0; });
+                    days = isNumber ? std::stoi(value) : 0;
+                    if (days < 1 || days > 3660)
+                    {
+                        std::cerr << "Error: '--days' must be between 1 and 3660." << std::endl;
+                        exitCode = 1;
+                    }
+                }
+                else
+                {
+                    std::cerr << "Error: Unknown option '" << arg << "' for 'stats'." << std::endl;
+                    printUsage();
+                    exitCode = 1;
+                }
+            }
+            if (exitCode == 0)
+            {
+                printStats(store.columns(TIMESTAMP_COLUMNS), days, json);
+            }
+        }
+        else if (command == "gen")
+        {
+            GenOptions options;
+            bool force = false;
+            if (!parseGenOptions(argc, argv, options, force))
+            {
+                printUsage();
+                exitCode = 1;
+            }
+            else if (!store.tasks.empty() && !force)
+            {
+                std::cerr << "Error: " << TASKS_FILE << " already contains " << store.tasks.size()
+                          << " tasks. Use --force to replace them." << std::endl;
+                exitCode = 1;
+            }
+            else
+            {
+                store.replaceAll(generateTasks(options, store.tasks.get_allocator().resource()));
+                store.save();
+                std::cout << "Generated " << store.tasks.size() << " tasks (seed " << options.seed << ")." << std::endl;
+            }
+        }
+        else if (command == "format")
+        {
+            std::optional<StoreFormat> format;
+            if (argc == 3)
+            {
+                std::string name = argv[2];
+                format = (name == "json")      ? std::optional(StoreFormat::JsonArray)
+                         : (name == "ndjson")  ? std::optional(StoreFormat::Ndjson)
+                         : (name == "sharded") ? std::optional(StoreFormat::Sharded)
+                                               : std::nullopt;
+            }
+            if (argc > 3 || (argc == 3 && !format))
+            {
+                std::cerr << "Error: 'format' takes at most one argument (json, ndjson or sharded)." << std::endl;
+                exitCode = 1;
+            }
+            else if (!format)
+            {
+                std::cout << "Store format: " << formatName(storeFormat) << std::endl;
+            }
+            else
+            {
+                storeFormat = *format;
+                store.save();
+                std::cout << "Store converted to " << formatName(storeFormat) << " (" << store.tasks.size() << " tasks)." << std::endl;
+            }
+        }
+        else if (command == "batch")
+        {
+            if (argc > 3)
+            {
+                std::cerr << "Error: 'batch' command takes at most one argument (file)." << std::endl;
+                printUsage();
+                exitCode = 1;
+            }
+            else if (argc == 3 && std::string(argv[2]) != "-")
+            {
+                std::ifstream input(argv[2]);
+                if (!input.is_open())
+                {
+                    std::cerr << "Error: Could not open batch file " << argv[2] << "." << std::endl;
+                    exitCode = 1;
+                }
+                else
+                {
+                    exitCode = runBatch(store, input);
+                }
+            }
+            else
+            {
+                exitCode = runBatch(store, std::cin);
+            }
+        }
+        else if (command == "metrics")
+        {
+            bool json = (argc == 3 && std::string(argv[2]) == "--json");
+            if (argc > 3 || (argc == 3 && !json))
+            {
+                std::cerr << "Error: 'metrics' command takes at most one option (--json)." << std::endl;
+                exitCode = 1;
+            }
+            else
+            {
+                operationMetrics.print(json);
             }
         }
-        // No need for explicit 'help' check here, handled at the top
         else
         {
             std::cerr << "Error: Unknown command '" << command << "'." << std::endl;
@@ -817,6 +5768,11 @@ int main(int argc, char *argv[])
         std::cerr << "Error: Provided task ID is too large or too small." << std::endl;
         exitCode = 1;
     }
+    catch (const std::bad_alloc &)
+    {
+        std::cerr << "Error: Out of memory (see --mem-cap)." << std::endl;
+        exitCode = 1;
+    }
     // Catch any other standard exceptions during command processing
     catch (const std::exception &e)
     {
@@ -824,5 +5780,128 @@ int main(int argc, char *argv[])
         exitCode = 1;
     }
 
+    if (command != "batch" && command != "metrics")
+    {
+        auto elapsed = std::chrono::steady_clock::now() - commandStart;
+        operationMetrics.record(command, static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+    }
+    return exitCode;
+}
+
+// --- Main Application Logic ---
+// Define TASK_CLI_NO_MAIN to include this file from another program (e.g. task-bench.cpp).
+#ifndef TASK_CLI_NO_MAIN
+int main(int argc, char *argv[])
+{
+    auto startTime = std::chrono::steady_clock::now();
+
+    // Global options come before the command; strip them so commands see their usual argv
+    std::vector<char *> args(argv, argv + argc);
+    bool statsJson = false;
+    size_t memCap = std::numeric_limits<size_t>::max();
+    while (args.size() > 1)
+    {
+        std::string option = args[1];
+        if (option == "--stats" || option == "--stats=json")
+        {
+            commandStats.enabled = true;
+            countAllocations = true;
+            statsJson = (option == "--stats=json");
+            args.erase(args.begin() + 1);
+        }
+        else if (option == "--trace" && args.size() > 2)
+        {
+            traceRecorder.enabled = true;
+            traceRecorder.path = args[2];
+            args.erase(args.begin() + 1, args.begin() + 3);
+        }
+        else if (option == "--no-cache")
+        {
+            parsedCacheEnabled = false;
+            args.erase(args.begin() + 1);
+        }
+        else if (option == "--mem-cap" && args.size() > 2)
+        {
+            std::optional<size_t> bytes = parseByteSize(args[2]);
+            if (!bytes)
+            {
+                std::cerr << "Error: --mem-cap must be a byte count with an optional K, M or G suffix." << std::endl;
+                return 1;
+            }
+            memCap = *bytes;
+            args.erase(args.begin() + 1, args.begin() + 3);
+        }
+        else
+        {
+            break;
+        }
+    }
+    argc = static_cast<int>(args.size());
+    argv = args.data();
+
+    // Check for help command or insufficient arguments
+    if (argc < 2 || std::string(argv[1]) == "help" || std::string(argv[1]) == "--help")
+    {
+        printUsage();
+        return (argc < 2); // Return 1 if no command given, 0 if 'help' was explicitly asked for
+    }
+
+    // Read-only commands never free store memory before exit, so a monotonic buffer (no
+    // per-allocation bookkeeping) fits them; batch runs many mutations and reuses freed
+    // blocks through a pool. Other commands load, change one task and save, except 'add' and
+    // 'mark-*', which load only if they cannot append or patch directly. Commands that only read also load
+    // lazily: fields are decoded when a command first touches them. 'show' reads only its task
+    // unless the metadata is stale.
+    std::string command = argv[1];
+    bool readOnly = command == "list" || command == "search" || command == "count" || command == "stats" || command == "show";
+    CountingResource storeMemory(std::pmr::new_delete_resource(), memCap);
+    std::optional<std::pmr::monotonic_buffer_resource> monotonic;
+    std::optional<std::pmr::unsynchronized_pool_resource> pool;
+    std::pmr::memory_resource *resource = &storeMemory;
+    if (readOnly || command == "metrics")
+    {
+        resource = &monotonic.emplace(&storeMemory);
+    }
+    else if (command == "batch")
+    {
+        resource = &pool.emplace(&storeMemory);
+    }
+
+    TaskStore store(resource);
+    try
+    {
+        if (command == "add" || command.starts_with("mark-") || command == "show")
+        {
+            store.unloaded = true; // Usually append, patch or read one task without reading the store
+        }
+        else
+        {
+            store.load(readOnly); // Load tasks at the beginning
+        }
+    }
+    catch (const std::bad_alloc &)
+    {
+        std::cerr << "Fatal Error during task loading: memory cap of " << memCap << " bytes exceeded." << std::endl;
+        return 1;
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "Fatal Error during task loading: " << e.what() << std::endl;
+        return 1; // Exit if loading fails critically
+    }
+
+    int exitCode = runCommand(store, argc, argv);
+
+    if (commandStats.enabled)
+    {
+        auto elapsed = std::chrono::steady_clock::now() - startTime;
+        reportCommandStats(std::chrono::duration<double, std::milli>(elapsed).count(), store.tasks.size(), storeMemory.peakBytes(), statsJson);
+    }
+    if (traceRecorder.enabled && !traceRecorder.write())
+    {
+        exitCode = 1;
+    }
+
     return exitCode; // Return 0 on success, 1 on error
 }
+#endif // TASK_CLI_NO_MAIN